@@ -0,0 +1,236 @@
+#include "../src/include/osolver.h"
+#include "../src/include/hungarian.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <iomanip>
+#include <numeric>
+
+#define KERNEL_REPETITIONS 100  // Default timed calls of each kernel
+#define KERNEL_BATCH 10000      // Calls of the cheap kernels timed together, a single one is shorter than a tick read
+
+volatile double sink; // Keeps the results of the batched kernels alive
+
+// Prints a row of the table. The moves are the ones the calls evaluated, 0 if the kernel doesn't count them
+void printKernel(const std::string &name, long calls, int64_t ticks, long moves){
+    double ns = ticks * Timer::tickLength();
+
+    std::cout << std::left << std::setw(24) << name << std::right
+              << std::setw(10) << calls
+              << std::setw(14) << std::fixed << std::setprecision(1) << ns / calls;
+
+    if(moves > 0)
+        std::cout << std::setw(14) << (double)moves / calls << std::setw(12) << std::setprecision(3) << ns / moves;
+    else
+        std::cout << std::setw(14) << "-" << std::setw(12) << "-";
+
+    std::cout << "\n";
+}
+
+void printHeader(const char *title){
+    std::cout << "\n" << title << "\n"
+              << std::left << std::setw(24) << "Kernel" << std::right << std::setw(10) << "Calls"
+              << std::setw(14) << "ns/call" << std::setw(14) << "moves/call" << std::setw(12) << "ns/move" << "\n";
+}
+
+// A class that times the kernels of the solvers on a fixed route, restoring the route before every call so they
+// all see the same input. A neighborhood call evaluates every move (the cache is off) and applies the best one
+class KernelBenchmark{
+    const Instance &instance_;
+    int repetitions_;
+    std::mt19937 rng_;
+    std::vector<int> route_;  // Random route from and back to the node 0
+
+    public:
+        KernelBenchmark(const Instance &instance, int repetitions, unsigned seed):
+        instance_(instance), repetitions_(repetitions), rng_(seed){
+            route_.resize(instance_.getDimension());
+            std::iota(route_.begin(), route_.end(), 0);
+            std::shuffle(route_.begin()+1, route_.end(), rng_);
+            route_.push_back(0);
+        }
+
+        // The solvers are only set up, the kernels run on their state without a solve
+        tParameters solverParameters(){
+            tParameters params;
+
+            params.quiet = true;
+            params.move_cache = false;
+            params.seed = 1;
+
+            return params;
+        }
+
+        void tsp(){
+            TSP tsp(instance_, solverParameters());
+            tSolution<double> initial;
+            int64_t ticks;
+
+            initial.route = route_;
+            initial.cost = tsp.getSolutionCost(initial);
+
+            printHeader("TSP");
+
+            for(int n = 0; n < tsp.neighborhoods_.size(); n++){
+                long moves = tsp.getInstrumentation().slots[TIMER_TOTAL-1].evaluated;
+
+                ticks = 0;
+                for(int r = 0; r < repetitions_; r++){
+                    tsp.s_ = initial;
+
+                    int64_t start = readTicks();
+                    tsp.searchNeighborhood(n);
+                    ticks += readTicks() - start;
+
+                    tsp.instrumentation_.record(TIMER_TOTAL-1, false, 0, 0);
+                }
+
+                moves = tsp.getInstrumentation().slots[TIMER_TOTAL-1].evaluated - moves;
+                printKernel(tsp.neighborhoods_[n].label, repetitions_, ticks, moves);
+            }
+
+            tsp.s_ = initial;
+            ticks = readTicks();
+            for(int r = 0; r < repetitions_; r++)
+                sink = tsp.getSolutionCost(tsp.s_);
+            printKernel("getSolutionCost", repetitions_, readTicks() - ticks, 0);
+        }
+
+        void mlp(){
+            MLP mlp(instance_, solverParameters());
+            tSolution<std::vector<std::vector<tCost>>> initial;
+            std::vector<std::pair<int, int>> ranges(KERNEL_BATCH);
+            int size = instance_.getDimension() + 1;
+            int64_t ticks;
+
+            mlp.s_.route = route_;
+            mlp.s_.cost[0][0] = {0, 0, 0};
+            for(int i = 1; i < size; i++)
+                mlp.s_.cost[i][i] = {1, 0, 0};
+            mlp.s_.cost[size-1][size-1] = {0, 0, 0};
+            mlp.fillCost();
+            initial = mlp.s_;
+
+            printHeader("MLP");
+
+            for(int n = 0; n < mlp.neighborhoods_.size(); n++){
+                long moves = mlp.getInstrumentation().slots[TIMER_TOTAL-1].evaluated;
+
+                ticks = 0;
+                for(int r = 0; r < repetitions_; r++){
+                    mlp.s_.route = initial.route;
+                    mlp.s_.cost = initial.cost;
+
+                    int64_t start = readTicks();
+                    mlp.searchNeighborhood(n);
+                    ticks += readTicks() - start;
+
+                    mlp.instrumentation_.record(TIMER_TOTAL-1, false, 0, 0);
+                }
+
+                moves = mlp.getInstrumentation().slots[TIMER_TOTAL-1].evaluated - moves;
+                printKernel(mlp.neighborhoods_[n].label, repetitions_, ticks, moves);
+            }
+
+            mlp.s_.route = initial.route;
+            mlp.s_.cost = initial.cost;
+
+            // Random pairs of disjoint subsequences [0, i] and [i+1, j]
+            for(std::pair<int, int> &range : ranges){
+                range.first = std::uniform_int_distribution<int>(0, size-2)(rng_);
+                range.second = std::uniform_int_distribution<int>(range.first+1, size-1)(rng_);
+            }
+
+            ticks = readTicks();
+            for(int r = 0; r < repetitions_; r++){
+                for(const std::pair<int, int> &range : ranges){
+                    tCost cost = mlp.s_.cost[0][range.first];
+                    mlp.concatenate(cost, mlp.s_.cost[range.first+1][range.second], range.first, range.first+1);
+                    sink = cost.c;
+                }
+            }
+            printKernel("concatenate", (long)repetitions_ * KERNEL_BATCH, readTicks() - ticks, 0);
+
+            ticks = readTicks();
+            for(int r = 0; r < repetitions_; r++)
+                mlp.fillCost();
+            printKernel("fillCost", repetitions_, readTicks() - ticks, 0);
+
+            // The ranges a swap or 2-opt of random positions recomputes
+            ticks = 0;
+            for(int r = 0; r < repetitions_; r++){
+                int first = std::uniform_int_distribution<int>(1, size-2)(rng_),
+                    last = std::uniform_int_distribution<int>(first, size-2)(rng_);
+
+                int64_t start = readTicks();
+                mlp.computeCost(first, last);
+                ticks += readTicks() - start;
+            }
+            printKernel("computeCost", repetitions_, ticks, 0);
+        }
+
+        // The assignment relaxation of the BB root node by both solvers. The conversion to the integer matrix is
+        // included for the Hungarian method, the Jonker-Volgenant solver reads the costs as they are
+        void assignment(){
+            hungarian_problem_t p;
+            int dimension = instance_.getDimension();
+            LinearAssignment<double> lap(dimension);
+            std::vector<double> costs(dimension * dimension);
+            int64_t ticks = 0;
+
+            for(int i = 0; i < dimension; i++)
+                for(int j = 0; j < dimension; j++)
+                    costs[i * dimension + j] = i == j ? HUNGARIAN_INFINITY : instance_.getMatrix()[i][j];
+
+            printHeader("BB");
+
+            for(int r = 0; r < repetitions_; r++){
+                int64_t start = readTicks();
+
+                hungarian_init(&p, instance_.getMatrix(), dimension, dimension, HUNGARIAN_MODE_MINIMIZE_COST);
+                for(int i = 0; i < dimension; i++)
+                    p.cost[i][i] = HUNGARIAN_INFINITY;
+                sink = hungarian_solve(&p);
+
+                ticks += readTicks() - start;
+                hungarian_free(&p);
+            }
+
+            printKernel("Hungarian", repetitions_, ticks, 0);
+
+            ticks = readTicks();
+            for(int r = 0; r < repetitions_; r++)
+                sink = lap.solve(costs.data());
+            printKernel("Jonker-Volgenant", repetitions_, readTicks() - ticks, 0);
+        }
+};
+
+int main(int argc, char **argv){
+    int repetitions = KERNEL_REPETITIONS;
+    unsigned seed = 1;
+    char *path = NULL;
+
+    for(int i = 1; i < argc; i++){
+        if(!strncmp(argv[i], "--repetitions=", 14))
+            repetitions = std::max(1, atoi(argv[i] + 14));
+        else if(!strncmp(argv[i], "--seed=", 7))
+            seed = strtoul(argv[i] + 7, NULL, 10);
+        else
+            path = argv[i];
+    }
+
+    if(path == NULL){
+        std::cout << "Usage: " << argv[0] << " instance [--repetitions=N] [--seed=S]\n";
+        return 1;
+    }
+
+    Instance instance(path);
+    std::cout << path << ": " << instance.getDimension() << " nodes, " << repetitions << " repetitions, seed " << seed << "\n";
+
+    KernelBenchmark benchmark(instance, repetitions, seed);
+    benchmark.tsp();
+    benchmark.mlp();
+    benchmark.assignment();
+
+    return 0;
+}
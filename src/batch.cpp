@@ -0,0 +1,179 @@
+#include "include/batch.h"
+#include "include/options.h"
+#include "include/read_data.h"
+#include "include/stream.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool parseJob(const std::string &line, const tParameters &defaults, tJob &job, std::string &error){
+    std::istringstream fields(line.substr(0, line.find(" : ")));
+    std::vector<std::string> tokens;
+    std::vector<char*> argv;
+    std::string token;
+
+    while(fields >> token)
+        tokens.push_back(token);
+
+    job.instance = tokens.empty() ? "" : tokens[0];
+    job.parameters = defaults;
+    job.mode = tokens.size() > 1 && (tokens[1] == "tsp" || tokens[1] == "mlp" || tokens[1] == "bb") ? tokens[1][0] : 0;
+    job.x.clear();
+    job.y.clear();
+
+    if(job.mode == 0){
+        error = "expected instance tsp|mlp|bb [budget] [options] [: x y x y ...]";
+        return false;
+    }
+
+    for(int k = 2; k < tokens.size(); k++)
+        argv.push_back(&tokens[k][0]);
+
+    for(int i = 0; i < argv.size(); i++){
+        if(i == 0 && argv[i][0] != '-'){
+            double budget = atof(argv[i]);
+            if(budget > 0)
+                job.parameters.time_limit = budget;
+        }
+        else if(strchr(argv[i], '=') == NULL && i+1 == argv.size()){
+            error = std::string("missing value for ") + argv[i];
+            return false;
+        }
+        else if(!parameterParse(argv.size(), argv.data(), i, job.parameters)){
+            error = std::string("unknown option ") + argv[i];
+            return false;
+        }
+    }
+
+    // Inline coordinates
+    if(line.find(" : ") != std::string::npos){
+        std::istringstream coordinates(line.substr(line.find(" : ") + 3));
+        double x, y;
+
+        while(coordinates >> x >> y){
+            job.x.push_back(x);
+            job.y.push_back(y);
+        }
+
+        job.dimension = job.x.size();
+    }
+    else
+        job.dimension = readDimension(job.instance.c_str());
+
+    if(job.dimension >= 0 && job.dimension < JOB_MIN_DIMENSION){
+        error = "too few nodes";
+        return false;
+    }
+
+    return true;
+}
+
+std::vector<tJob> readManifest(const char *path, const tParameters &defaults){
+    std::ifstream in(path);
+    std::vector<tJob> jobs;
+    std::string line, error;
+    int number = 0;
+
+    if(!in){
+        std::cerr << "\nERROR: Could not open " << path << "\n";
+        exit(1);
+    }
+
+    while(std::getline(in, line)){
+        tJob job;
+
+        number++;
+        line.erase(0, line.find_first_not_of(" \t"));
+
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        if(!parseJob(line, defaults, job, error)){
+            std::cerr << "\nERROR: " << path << ":" << number << ": " << error << "\n";
+            exit(1);
+        }
+
+        job.line = number;
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+SharedInstances::SharedInstances(const std::vector<tJob> &jobs){
+    for(const tJob &job : jobs)
+        if(job.x.empty())
+            entries_[job.instance].jobs++;
+}
+
+std::shared_ptr<Instance> SharedInstances::acquire(const tJob &job){
+    if(!job.x.empty())
+        return std::make_shared<Instance>(job.x, job.y);
+
+    tEntry &entry = entries_.at(job.instance);
+    std::lock_guard<std::mutex> lock(entry.mutex);
+
+    if(!entry.read){
+        entry.read = true;
+        if(job.dimension > 0 && std::ifstream(job.instance))
+            entry.instance = std::make_shared<Instance>(job.instance);
+    }
+
+    return entry.instance;
+}
+
+void SharedInstances::release(const tJob &job){
+    if(!job.x.empty())
+        return;
+
+    tEntry &entry = entries_.at(job.instance);
+    std::lock_guard<std::mutex> lock(entry.mutex);
+
+    if(--entry.jobs == 0)
+        entry.instance.reset();
+}
+
+bool largeJob(const tJob &job){
+    return job.mode == 't' && (job.parameters.decomposition > 0 || job.dimension >= BATCH_LARGE_DIMENSION);
+}
+
+const char* modeName(char mode){
+    return mode == 'm' ? "mlp" : mode == 'b' ? "bb" : "tsp";
+}
+
+void writeResult(std::ostream &out, int index, const tJob &job, const tResult &result){
+    std::streamsize precision = out.precision(15);
+
+    out << "{\"event\":\"result\"";
+
+    if(index >= 0)
+        out << ",\"job\":" << index;
+
+    out << ",\"instance\":" << jsonString(job.instance)
+        << ",\"mode\":\"" << modeName(job.mode) << "\""
+        << ",\"cost\":" << result.cost;
+
+    if(result.lower_bound > 0)
+        out << ",\"lower_bound\":" << result.lower_bound;
+
+    out << ",\"time\":" << result.time << ",\"route\":[";
+    for(int i = 0; i < result.route.size(); i++)
+        out << (i ? "," : "") << result.route[i]+1;
+    out << "]}" << std::endl;
+
+    out.precision(precision);
+}
+
+void writeError(std::ostream &out, int index, const tJob &job, const char *message){
+    out << "{\"event\":\"error\"";
+
+    if(index >= 0)
+        out << ",\"job\":" << index;
+
+    out << ",\"instance\":" << jsonString(job.instance)
+        << ",\"mode\":\"" << modeName(job.mode) << "\""
+        << ",\"message\":" << jsonString(message) << "}" << std::endl;
+}
@@ -1,32 +1,96 @@
 #include "include/bb.h"
 
-BB::BB(double ***matrix_pointer, int dimension): Problem(matrix_pointer, dimension){
+BB::BB(double ***matrix_pointer, int dimension, const tParameters &params):
+Problem(matrix_pointer, dimension, params), heuristic_(matrix_pointer, dimension, params){
+    p_.num_rows = p_.num_cols = 0;
+    p_.cost = p_.assignment = NULL;
+
+    configure(params_);
+}
+
+BB::BB(const Instance &instance, const tParameters &params): Problem(instance, params), heuristic_(instance, params){
+    p_.num_rows = p_.num_cols = 0;
+    p_.cost = p_.assignment = NULL;
+
+    configure(params_);
+}
+
+BB::~BB(){
+    if(p_.cost != NULL)
+        hungarian_free(&p_);
+}
+
+void BB::configure(const tParameters &params){
+    Problem::configure(params);
+
     // Heuristic used to get an initial upper bound
-    TSP heuristic = TSP(matrix_pointer, dimension, 1);
+    tParameters heuristic_params = params_;
+    heuristic_params.restarts = 1;
+    heuristic_params.observer = nullptr;
 
-    // The chosen subtour index
-    int index;
+    heuristic_.configure(heuristic_params);
+}
+
+// The assignment workspace is only allocated again for another dimension
+void BB::setInstance(const Instance &instance){
+    Problem::setInstance(instance);
+    heuristic_.setInstance(instance);
+
+    if(p_.cost != NULL && p_.num_rows != dimension_)
+        hungarian_free(&p_);
+}
+
+void BB::solve(){
+    reset();
+    timer_.setLabel(0, "Heuristic");
+    timer_.setLabel(1, "Node solve");
+
+    timer_.setTime(0);
+    heuristic_.solve();
+    instrumentation_.record(0, false, 0, timer_.setTime(0));
 
+    // The workspace of the assignment problems is kept between the nodes, each one starts from the costs of the root.
+    // The loops are forbidden on them, the matrix may be shared with other solvers
+    if(params_.assignment == 'h' && p_.cost == NULL)
+        hungarian_init(&p_, matrix_, dimension_, dimension_, HUNGARIAN_MODE_MINIMIZE_COST);
+
+    lap_.resize(dimension_);
+    node_costs_.resize(dimension_ * dimension_);
+    successors_.resize(dimension_);
+
+    costs_.resize(dimension_ * dimension_);
     for(int i = 0; i < dimension_; i++)
-        matrix_[i][i] = HUNGARIAN_INFINITY;
+        for(int j = 0; j < dimension_; j++)
+            costs_[i * dimension_ + j] = i == j ? HUNGARIAN_INFINITY : matrix_[i][j];
+
+    // The chosen subtour index
+    int index;
+    long nodes = 0;
 
     // Inserting the root node
+    tree_.clear();
     tree_.push_front({{}, HUNGARIAN_INFINITY});
 
-    // s_ = heuristic.getSolution();
-    // upper_bound = heuristic.getCost();
-    upper_bound = HUNGARIAN_INFINITY;
-    s_.cost = HUNGARIAN_INFINITY;
+    // The heuristic tour is the first incumbent, so its cost prunes the tree from the start and it is kept if the
+    // time runs out before a better tour is found
+    s_ = heuristic_.getSolution();
+    upper_bound = s_.cost;
+    newIncumbent(s_.route, s_.cost, nodes);
 
     // Executing until there is no nodes left to process
-    while(!tree_.empty()){        
-        hungarian_init(&p_, matrix_, dimension_, dimension_, HUNGARIAN_MODE_MINIMIZE_COST);
+    while(!tree_.empty()){
+        if(stop(s_.cost))
+            break;
 
+        timer_.setTime(1);
         current_node = tree_.begin();
             
         vector_solve();
+        instrumentation_.record(1, subtours_.size() == 1 && current_node->cost < s_.cost, 0, timer_.setTime(1));
+        nodes++;
 
-        if(current_node->cost > upper_bound){
+        // A node can't lead to a better tour than the incumbent if its relaxation already costs as much
+        if(current_node->cost >= upper_bound){
             tree_.erase(current_node);
 			continue;
         }
@@ -35,7 +99,7 @@ BB::BB(double ***matrix_pointer, int dimension): Problem(matrix_pointer, dimensi
 			if(current_node->cost < s_.cost){
 				s_ = {subtours_[0], current_node->cost};
 				upper_bound = current_node->cost;
-                std::cout << "New minimum: " << s_.cost << "\n";
+                newIncumbent(s_.route, s_.cost, nodes);
 			}
 
 			tree_.erase(current_node);
@@ -61,12 +125,12 @@ BB::BB(double ***matrix_pointer, int dimension): Problem(matrix_pointer, dimensi
 
         // After we generated the children, we can delete the node
         tree_.erase(current_node);
-
-        hungarian_free(&p_);
     }
+
+    timer_.stop();
 }
 
-// A function that solves and converts the resulting assignment matrix generated by the hungarian algorithm to a vector of subtours_
+// A function that solves the assignment problem of the current node and converts the resulting assignment to a vector of subtours_
 void BB::vector_solve(){
     std::vector<int> subtour = {0};
     bool used_nodes[dimension_] = {};
@@ -74,23 +138,38 @@ void BB::vector_solve(){
 
     subtours_.clear();
 
-    // Prohibiting the set of arcs of the current node
-    for(int i = 0; i < current_node->forbidden.size(); i++)
-        p_.cost[current_node->forbidden[i].first][current_node->forbidden[i].second] = HUNGARIAN_INFINITY;
+    // Prohibiting the set of arcs of the current node on a copy of the root costs
+    if(params_.assignment == 'h'){
+        for(int i = 0; i < dimension_; i++)
+            std::copy(costs_.begin() + i * dimension_, costs_.begin() + (i+1) * dimension_, p_.cost[i]);
+
+        for(int i = 0; i < current_node->forbidden.size(); i++)
+            p_.cost[current_node->forbidden[i].first][current_node->forbidden[i].second] = HUNGARIAN_INFINITY;
+
+        current_node->cost = hungarian_solve(&p_);
+
+        for(int i = 0; i < dimension_; i++)
+            for(int j = 0; j < dimension_; j++)
+                if(p_.assignment[i][j])
+                    successors_[i] = j;
+    }
+    else{
+        std::copy(costs_.begin(), costs_.end(), node_costs_.begin());
+
+        for(int i = 0; i < current_node->forbidden.size(); i++)
+            node_costs_[current_node->forbidden[i].first * dimension_ + current_node->forbidden[i].second] = HUNGARIAN_INFINITY;
+
+        current_node->cost = lap_.solve(node_costs_.data());
+        successors_ = lap_.getAssignment();
+    }
 
-    current_node->cost = hungarian_solve(&p_);
     used_nodes[0] = true;
 
-    // Matrix to vector conversion
+    // Assignment to vector conversion
     do{
         do{
-            for(int i = 0; i < dimension_; i++){
-                if(p_.assignment[subtour[subtour.size()-1]][i]){
-                    subtour.push_back(i);
-                    used_nodes[i] = true;
-                    break;
-                }
-            }
+            subtour.push_back(successors_[subtour[subtour.size()-1]]);
+            used_nodes[subtour[subtour.size()-1]] = true;
         }while((subtour[0] != subtour[subtour.size()-1]));
         
         subtours_.push_back(subtour);
@@ -124,8 +203,8 @@ void BB::printSolution(){
     printRoute(s_.route);
 }
 
-void BB::printTimes(){
-    std::cout << "AAA\n";
+const std::vector<int>& BB::getRoute(){
+    return s_.route;
 }
 
 double BB::getCost(){
@@ -137,7 +216,7 @@ void BB::printAssingmentMatrix(){
     for(int i = 0; i < dimension_; i++){
         for(int j = 0; j < dimension_; j++){
             char endian = ((j+1)==dimension_) ? '\n' : ' ';
-            std::cout << p_.assignment[i][j] << endian;
+            std::cout << (successors_[i] == j) << endian;
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,438 @@
+#include "include/benchmark.h"
+#include "include/perf_counters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <glob.h>
+
+std::vector<std::string> expandInstances(const std::vector<std::string> &arguments){
+    std::vector<std::string> instances;
+
+    for(const std::string &argument : arguments){
+        if(argument[0] == '@'){
+            std::ifstream in(argument.substr(1));
+            std::vector<std::string> listed;
+            std::string line;
+
+            if(!in){
+                std::cerr << "\nERROR: Could not open " << argument.substr(1) << "\n";
+                exit(1);
+            }
+
+            while(std::getline(in, line)){
+                line.erase(0, line.find_first_not_of(" \t"));
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+
+                if(!line.empty() && line[0] != '#')
+                    listed.push_back(line);
+            }
+
+            std::vector<std::string> expanded = expandInstances(listed);
+            instances.insert(instances.end(), expanded.begin(), expanded.end());
+            continue;
+        }
+
+        glob_t matches;
+
+        // A name without wildcards comes back as is, so a missing file is reported when it is read
+        if(glob(argument.c_str(), GLOB_NOCHECK, NULL, &matches) == 0)
+            for(size_t i = 0; i < matches.gl_pathc; i++)
+                instances.push_back(matches.gl_pathv[i]);
+
+        globfree(&matches);
+    }
+
+    return instances;
+}
+
+std::map<std::string, double> readOptima(const char *path){
+    std::map<std::string, double> optima;
+    std::ifstream in(path);
+    std::string line, name;
+    double cost;
+
+    while(std::getline(in, line)){
+        std::istringstream fields(line);
+
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        if(fields >> name >> cost)
+            optima[name] = cost;
+    }
+
+    return optima;
+}
+
+// Returns the file name of an instance without its directory and extension
+std::string instanceName(const std::string &path){
+    std::string name = path.substr(path.find_last_of('/') + 1);
+
+    return name.substr(0, name.find_last_of('.'));
+}
+
+// A function that computes the statistics of the values, ignoring the NAN ones (all NAN if every value is)
+static tStatistics statistics(std::vector<double> values){
+    tStatistics result = {NAN, NAN, NAN, NAN};
+    double sum = 0, squares = 0;
+    int n;
+
+    values.erase(std::remove_if(values.begin(), values.end(), [](double value){ return std::isnan(value); }), values.end());
+
+    if((n = values.size()) == 0)
+        return result;
+
+    std::sort(values.begin(), values.end());
+
+    for(double value : values)
+        sum += value;
+
+    result.min = values[0];
+    result.mean = sum / n;
+    result.median = n % 2 ? values[n/2] : (values[n/2 - 1] + values[n/2]) / 2;
+
+    for(double value : values)
+        squares += (value - result.mean) * (value - result.mean);
+
+    result.stdev = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+
+    return result;
+}
+
+tSummary summarize(const std::string &path, const std::string &mode, int dimension, unsigned seed, double optimum,
+                   const std::vector<std::string> &labels, const std::vector<tRun> &runs){
+    tSummary summary;
+    std::vector<double> costs, gaps, walls, cpus;
+
+    summary.instance = instanceName(path);
+    summary.mode = mode;
+    summary.dimension = dimension;
+    summary.runs = runs.size();
+    summary.seed = seed;
+    summary.optimum = optimum;
+
+    for(const tRun &run : runs){
+        costs.push_back(run.cost);
+        gaps.push_back(run.gap);
+        walls.push_back(run.wall);
+        cpus.push_back(run.cpu);
+    }
+
+    summary.cost = statistics(costs);
+    summary.gap = statistics(gaps);
+    summary.wall = statistics(walls);
+    summary.cpu = statistics(cpus);
+
+    for(int j = 0; j < labels.size(); j++){
+        double total = 0;
+
+        if(labels[j].empty())
+            continue;
+
+        for(const tRun &run : runs)
+            total += run.phases[j];
+
+        summary.phases.push_back({labels[j], total / runs.size()});
+
+        if(!runs.empty() && !runs[0].counts.empty()){
+            std::vector<uint64_t> counts(PERF_EVENTS, 0);
+
+            for(const tRun &run : runs)
+                for(int event = 0; event < PERF_EVENTS; event++)
+                    counts[event] += run.counts[j][event];
+
+            for(int event = 0; event < PERF_EVENTS; event++)
+                counts[event] /= runs.size();
+
+            summary.counts.push_back(counts);
+        }
+    }
+
+    return summary;
+}
+
+void printSummary(std::ostream &out, const tSummary &summary){
+    out << "\n--------======== " << summary.instance << " (" << summary.runs << " runs, seed " << summary.seed << ") ========---------\n"
+        << "Cost: min " << summary.cost.min << ", mean " << summary.cost.mean << ", median " << summary.cost.median
+        << ", stdev " << summary.cost.stdev << "\n";
+
+    if(!std::isnan(summary.gap.mean))
+        out << "Gap" << (std::isnan(summary.optimum) ? "" : " to " + std::to_string((long long) summary.optimum)) << ": min "
+            << summary.gap.min << "%, mean " << summary.gap.mean << "%, median " << summary.gap.median << "%\n";
+
+    out << "Execution time: mean " << summary.wall.mean << " (s), median " << summary.wall.median << " (s), stdev "
+        << summary.wall.stdev << " (s), CPU " << summary.cpu.mean << " (s)\n";
+
+    for(int j = 0; j < summary.phases.size(); j++){
+        out << "| " << summary.phases[j].first << " execution time: " << summary.phases[j].second << " (s)";
+        if(!summary.counts.empty())
+            printPerf(out, summary.counts[j].data());
+        out << "\n";
+    }
+}
+
+// A function that writes a number, or the given text in place of NAN
+static void writeValue(std::ostream &out, double value, const char *missing){
+    if(std::isnan(value))
+        out << missing;
+    else
+        out << value;
+}
+
+static void writeStatisticsJSON(std::ostream &out, const char *name, const tStatistics &statistics){
+    const char *fields[] = {"min", "mean", "median", "stdev"};
+    double values[] = {statistics.min, statistics.mean, statistics.median, statistics.stdev};
+
+    out << ",\"" << name << "\":{";
+    for(int k = 0; k < 4; k++){
+        out << (k ? "," : "") << "\"" << fields[k] << "\":";
+        writeValue(out, values[k], "null");
+    }
+    out << "}";
+}
+
+static void writeStatisticsCSV(std::ostream &out, const tStatistics &statistics){
+    for(double value : {statistics.min, statistics.mean, statistics.median, statistics.stdev}){
+        out << ",";
+        writeValue(out, value, "");
+    }
+}
+
+bool writeReport(const char *path, const std::vector<tSummary> &summaries){
+    std::string name(path);
+    std::ofstream out(path);
+    bool json = name.size() >= 5 && name.compare(name.size() - 5, 5, ".json") == 0;
+
+    if(!out)
+        return false;
+
+    out.precision(15);
+
+    if(json){
+        out << "[\n";
+
+        for(int i = 0; i < summaries.size(); i++){
+            const tSummary &summary = summaries[i];
+
+            out << "{\"instance\":\"" << summary.instance << "\",\"mode\":\"" << summary.mode << "\""
+                << ",\"dimension\":" << summary.dimension << ",\"runs\":" << summary.runs << ",\"seed\":" << summary.seed
+                << ",\"optimum\":";
+            writeValue(out, summary.optimum, "null");
+
+            writeStatisticsJSON(out, "cost", summary.cost);
+            writeStatisticsJSON(out, "gap", summary.gap);
+            writeStatisticsJSON(out, "wall", summary.wall);
+            writeStatisticsJSON(out, "cpu", summary.cpu);
+
+            out << ",\"phases\":{";
+            for(int j = 0; j < summary.phases.size(); j++)
+                out << (j ? "," : "") << "\"" << summary.phases[j].first << "\":" << summary.phases[j].second;
+            out << "}";
+
+            if(!summary.counts.empty()){
+                out << ",\"counters\":{";
+                for(int j = 0; j < summary.phases.size(); j++){
+                    out << (j ? "," : "") << "\"" << summary.phases[j].first << "\":{";
+                    for(int event = 0; event < PERF_EVENTS; event++)
+                        out << (event ? "," : "") << "\"" << PERF_NAMES[event] << "\":" << summary.counts[j][event];
+                    out << "}";
+                }
+                out << "}";
+            }
+
+            out << "}" << (i+1 < summaries.size() ? "," : "") << "\n";
+        }
+
+        out << "]\n";
+    }
+    else{
+        out << "instance,mode,dimension,runs,seed,optimum"
+            << ",cost_min,cost_mean,cost_median,cost_stdev,gap_min,gap_mean,gap_median,gap_stdev"
+            << ",wall_min,wall_mean,wall_median,wall_stdev,cpu_min,cpu_mean,cpu_median,cpu_stdev,phases,counters\n";
+
+        // The phases go in a single "label=seconds;..." column, as each solver has its own
+        for(const tSummary &summary : summaries){
+            out << summary.instance << "," << summary.mode << "," << summary.dimension << "," << summary.runs << ","
+                << summary.seed << ",";
+            writeValue(out, summary.optimum, "");
+
+            writeStatisticsCSV(out, summary.cost);
+            writeStatisticsCSV(out, summary.gap);
+            writeStatisticsCSV(out, summary.wall);
+            writeStatisticsCSV(out, summary.cpu);
+
+            out << ",\"";
+            for(int j = 0; j < summary.phases.size(); j++)
+                out << (j ? ";" : "") << summary.phases[j].first << "=" << summary.phases[j].second;
+            out << "\",\"";
+
+            // The counts of each phase in the order of PERF_NAMES, separated by slashes
+            for(int j = 0; j < summary.counts.size(); j++){
+                out << (j ? ";" : "") << summary.phases[j].first << "=";
+                for(int event = 0; event < PERF_EVENTS; event++)
+                    out << (event ? "/" : "") << summary.counts[j][event];
+            }
+            out << "\"\n";
+        }
+    }
+
+    return true;
+}
+
+// Gaps (%) to the reference cost of the time to target distributions
+static const double ttt_gaps[] = {0, 0.5, 1, 2, 5};
+
+// A function that returns the cost of the run's best incumbent at the time, INFINITY before its first one
+static double costAt(const tRun &run, double time){
+    double cost = INFINITY;
+
+    for(const std::pair<double, double> &point : run.trajectory){
+        if(point.first > time)
+            break;
+        cost = std::min(cost, point.second);
+    }
+
+    return cost;
+}
+
+bool writeCurves(const char *prefix, const std::vector<tSummary> &summaries, const std::vector<std::vector<tRun>> &runs){
+    std::ofstream trajectories(std::string(prefix) + "-trajectories.csv"),
+                  ttt(std::string(prefix) + "-ttt.csv"),
+                  anytime(std::string(prefix) + "-anytime.csv");
+
+    if(!trajectories || !ttt || !anytime)
+        return false;
+
+    trajectories.precision(15);
+    ttt.precision(15);
+    anytime.precision(15);
+
+    trajectories << "instance,run,seed,time,cost\n";
+    ttt << "instance,reference,target_gap,target,run,time,probability\n";
+    anytime << "instance,reference,time,runs,mean_cost,mean_gap\n";
+
+    for(int k = 0; k < summaries.size(); k++){
+        const tSummary &summary = summaries[k];
+        double reference = summary.optimum,
+               first = INFINITY,
+               last = 0;
+
+        // The best cost of the runs when the optimum is unknown
+        if(std::isnan(reference))
+            reference = summary.cost.min;
+
+        for(int r = 0; r < runs[k].size(); r++){
+            const tRun &run = runs[k][r];
+
+            for(const std::pair<double, double> &point : run.trajectory)
+                trajectories << summary.instance << "," << r+1 << "," << run.seed << "," << point.first << "," << point.second << "\n";
+
+            if(!run.trajectory.empty())
+                first = std::min(first, std::max(run.trajectory[0].first, 1e-6));
+            last = std::max(last, run.wall);
+        }
+
+        // The empirical distribution of the time to reach each target, (i - 1/2) / runs for the i-th fastest run,
+        // so the runs that never reach it keep the curve below 1
+        for(double gap : ttt_gaps){
+            double target = reference * (1 + gap / 100);
+            std::vector<std::pair<double, int>> times;
+
+            for(int r = 0; r < runs[k].size(); r++)
+                for(const std::pair<double, double> &point : runs[k][r].trajectory)
+                    if(point.second <= target + 1e-9 * std::fabs(target)){
+                        times.push_back({point.first, r+1});
+                        break;
+                    }
+
+            std::sort(times.begin(), times.end());
+
+            for(int i = 0; i < times.size(); i++)
+                ttt << summary.instance << "," << reference << "," << gap << "," << target << "," << times[i].second << ","
+                    << times[i].first << "," << (i + 0.5) / runs[k].size() << "\n";
+        }
+
+        if(first > last)
+            continue;
+
+        // The mean over the runs that have an incumbent by then
+        for(int i = 0; i < ANYTIME_POINTS; i++){
+            double time = first * std::pow(last / first, (double) i / (ANYTIME_POINTS - 1)),
+                   total = 0;
+            int count = 0;
+
+            for(const tRun &run : runs[k]){
+                double cost = costAt(run, time);
+
+                if(cost < INFINITY){
+                    total += cost;
+                    count++;
+                }
+            }
+
+            if(count == 0)
+                continue;
+
+            anytime << summary.instance << "," << reference << "," << time << "," << count << "," << total / count << ","
+                    << 100 * (total / count - reference) / reference << "\n";
+        }
+    }
+
+    return true;
+}
+
+// A function that checks if the value grew by more than the threshold (%) from the baseline one, and reports it
+static bool regression(std::ostream &out, const tSummary &summary, const char *name, double value, double baseline, double threshold){
+    if(std::isnan(value) || std::isnan(baseline) || baseline <= 0 || 100 * (value - baseline) / baseline <= threshold)
+        return false;
+
+    out << "REGRESSION " << summary.instance << " (" << summary.mode << "): " << name << " " << baseline << " -> "
+        << value << " (+" << 100 * (value - baseline) / baseline << "%)\n";
+
+    return true;
+}
+
+int compareBaseline(std::ostream &out, const char *path, const std::vector<tSummary> &summaries, double threshold){
+    std::ifstream in(path);
+    std::string line, field;
+    std::vector<std::string> header;
+    std::map<std::string, std::pair<double, double>> baseline; // Mean cost and wall time by instance and mode
+    int regressions = 0;
+
+    if(!in || !std::getline(in, line)){
+        std::cerr << "\nERROR: Could not read the baseline " << path << "\n";
+        exit(1);
+    }
+
+    for(std::istringstream fields(line); std::getline(fields, field, ',');)
+        header.push_back(field);
+
+    while(std::getline(in, line)){
+        std::istringstream fields(line);
+        std::map<std::string, std::string> row;
+
+        for(int k = 0; k < header.size() && std::getline(fields, field, ','); k++)
+            row[header[k]] = field;
+
+        if(row.count("instance") && row.count("cost_mean") && row.count("wall_mean"))
+            baseline[row["instance"] + "/" + row["mode"]] = {row["cost_mean"].empty() ? NAN : atof(row["cost_mean"].c_str()),
+                                                             row["wall_mean"].empty() ? NAN : atof(row["wall_mean"].c_str())};
+    }
+
+    for(const tSummary &summary : summaries){
+        auto entry = baseline.find(summary.instance + "/" + summary.mode);
+
+        if(entry == baseline.end())
+            continue;
+
+        regressions += regression(out, summary, "mean cost", summary.cost.mean, entry->second.first, threshold);
+        if(entry->second.second >= REGRESSION_MIN_TIME)
+            regressions += regression(out, summary, "mean time", summary.wall.mean, entry->second.second, threshold);
+    }
+
+    return regressions;
+}
@@ -0,0 +1,129 @@
+#include "include/decomposition.h"
+#include "include/tsp.h"
+
+#include <numeric>
+
+Decomposition::Decomposition(double **matrix, int dimension, const tParameters &params, unsigned seed):
+matrix_(matrix), dimension_(dimension), segment_(params.decomposition), params_(params), pool_(params.threads), rng_(seed){
+    // The subproblems run silently on their own nodes, with the stopping criteria of the whole tour left out
+    params_.quiet = true;
+    params_.observer = nullptr;
+    params_.x = params_.y = NULL;
+    params_.decomposition = 0;
+    params_.restarts = 1;
+    params_.stagnation = params.stagnation ? params.stagnation : DECOMPOSITION_STAGNATION;
+    params_.target = params_.gap_limit = 0;
+}
+
+// Optimizes every segment of the route, the first one starting at the given offset, and returns the cost change.
+// The route comes back rotated by the offset, so a constant offset shifts the cuts from round to round
+double Decomposition::round(std::vector<int> &route, int offset, std::chrono::steady_clock::time_point deadline){
+    std::vector<int> tour(route.begin(), route.end()-1);
+    int segments = std::max(1, dimension_ / segment_);
+    std::vector<double> deltas(segments, 0);
+
+    std::rotate(tour.begin(), tour.begin() + offset % dimension_, tour.end());
+    tour.push_back(tour[0]);
+
+    // The last segment takes the remainder, so none of them is too short to optimize
+    for(int k = 0; k < segments; k++){
+        int first = k * segment_,
+            last = k+1 == segments ? dimension_ : first + segment_;
+        unsigned seed = rng_();
+
+        pool_.submit([this, &tour, &deltas, k, first, last, seed, deadline](){
+            deltas[k] = optimizeSegment(tour, first, last, seed, deadline);
+        });
+    }
+
+    pool_.wait();
+    route = tour;
+
+    return std::accumulate(deltas.begin(), deltas.end(), 0.0);
+}
+
+// Solves the path tour[first..last] with fixed ends as a TSP over its nodes, in which the edge between the ends
+// costs nothing and every other edge at an end costs more than any path, so the good tours keep the ends joined.
+// The path is replaced only if the subproblem improved it; returns the cost change. The subproblem gets the time left
+// until the deadline when its task starts, since the tasks may wait for a worker
+double Decomposition::optimizeSegment(std::vector<int> &tour, int first, int last, unsigned seed,
+                                      std::chrono::steady_clock::time_point deadline){
+    int size = last - first + 1,
+        end = size - 1;
+    std::vector<double> storage(size * size);
+    std::vector<double*> rows(size);
+    std::vector<int> initial(size+1);
+    double **matrix = rows.data(),
+           longest = 0,
+           before = 0,
+           after = 0;
+
+    double time_limit = 0;
+
+    if(deadline != std::chrono::steady_clock::time_point::max()){
+        time_limit = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+
+        if(time_limit <= 0)
+            return 0;
+    }
+
+    if(size < LK_MIN_DIMENSION)
+        return 0;
+
+    for(int i = 0; i < size; i++){
+        rows[i] = &storage[i * size];
+
+        for(int j = 0; j < size; j++){
+            matrix[i][j] = matrix_[tour[first+i]][tour[first+j]];
+            longest = std::max(longest, matrix[i][j]);
+        }
+    }
+
+    double big = size * longest + 1;
+
+    for(int j = 1; j < end; j++){
+        matrix[0][j] += big;
+        matrix[j][0] += big;
+        matrix[end][j] += big;
+        matrix[j][end] += big;
+    }
+    matrix[0][end] = matrix[end][0] = 0;
+
+    // The current path, closed by the free edge
+    std::iota(initial.begin(), initial.end()-1, 0);
+    initial[size] = 0;
+
+    tParameters params = params_;
+    params.seed = seed;
+    params.time_limit = time_limit;
+    params.initial = &initial;
+
+    TSP tsp(&matrix, size, params);
+    tsp.solve();
+    std::vector<int> result(tsp.getRoute().begin(), tsp.getRoute().end()-1);
+
+    // From the first end, away from the last one
+    std::rotate(result.begin(), std::find(result.begin(), result.end(), 0), result.end());
+    if(result[1] == end)
+        std::reverse(result.begin()+1, result.end());
+
+    if(result.back() != end)
+        return 0;
+
+    for(int k = 0; k < end; k++){
+        before += matrix_[tour[first+k]][tour[first+k+1]];
+        after += matrix_[tour[first+result[k]]][tour[first+result[k+1]]];
+    }
+
+    if(after >= before - IMPROVEMENT_EPSILON)
+        return 0;
+
+    // Only the inner nodes are written, the ends are shared with the neighboring segments
+    std::vector<int> path(size);
+    for(int k = 0; k < size; k++)
+        path[k] = tour[first+result[k]];
+
+    std::copy(path.begin()+1, path.end()-1, tour.begin() + first+1);
+
+    return after - before;
+}
@@ -0,0 +1,69 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "structures.h"
+#include "instance.h"
+
+#define BATCH_LARGE_DIMENSION 5000  // TSP jobs from this dimension on are solved one at a time by a parallel decomposition
+#define BATCH_DECOMPOSITION 200     // Nodes per segment of the decomposition of the large jobs, unless the job sets it
+#define JOB_MIN_DIMENSION 5         // Fewest nodes of a job, the constructions need a few
+
+// A structure that represents a job of a batch manifest
+struct tJob{
+    std::string instance;
+    char mode;                  // 't'sp, 'm'lp or 'b'b
+    tParameters parameters;
+    std::vector<double> x, y;   // Inline coordinates of a Euclidean instance, empty for an instance file
+    int dimension,              // From the instance header, -1 if it couldn't be read
+        line;                   // Line of the manifest
+};
+
+// The instances of a batch: every file is read once, by the first of its jobs to run, shared read-only by the jobs
+// on it and freed after the last one. The jobs with inline coordinates get an instance of their own
+class SharedInstances{
+    // A structure that stores the instance of a file and the jobs on it not released yet
+    struct tEntry{
+        std::shared_ptr<Instance> instance;
+        int jobs = 0;
+        bool read = false;
+        std::mutex mutex;   // Held while the first job reads the file, so the others wait for it
+    };
+
+    std::map<std::string, tEntry> entries_; // By path, complete before the jobs start
+
+    public:
+        SharedInstances(const std::vector<tJob> &jobs);
+
+        // Returns the instance of the job, or NULL if it can't be read
+        std::shared_ptr<Instance> acquire(const tJob &job);
+
+        void release(const tJob &job);
+};
+
+// Parses a job "instance mode [budget] [options]" starting from the given parameters: the mode is tsp, mlp or bb,
+// the budget is a time limit in seconds (0 keeps the default) and the options are solver parameters (--stagnation=N,
+// ...). A trailing " : x y x y ..." gives the coordinates of a Euclidean instance instead of a file.
+// Returns false with the reason if the job is malformed
+bool parseJob(const std::string &line, const tParameters &defaults, tJob &job, std::string &error);
+
+// Reads a manifest with a job per line, lines starting with # are comments
+std::vector<tJob> readManifest(const char *path, const tParameters &defaults);
+
+// Whether the job is solved alone with intra-solve parallelism
+bool largeJob(const tJob &job);
+
+const char* modeName(char mode);
+
+// Writes the outcome of a job as a single line of JSON, or the error that kept it from being solved.
+// The index of the job is left out if negative
+void writeResult(std::ostream &out, int index, const tJob &job, const tResult &result);
+
+void writeError(std::ostream &out, int index, const tJob &job, const char *message);
+
+#endif // BATCH_H
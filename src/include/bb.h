@@ -4,6 +4,7 @@
 #include <list>
 #include "problem.h"
 #include "hungarian.h"
+#include "lap.h"
 #include "structures.h"
 #include "tsp.h"
 
@@ -12,7 +13,15 @@
 class BB : public Problem{
     tSolution<double> s_;
 
-    hungarian_problem_t p_;
+    TSP heuristic_; // Finds the tour kept when the time runs out first
+
+    hungarian_problem_t p_;             // Workspace of the --assignment=hungarian solves
+    LinearAssignment<double> lap_;
+
+    std::vector<double> costs_,         // Assignment costs of the root node, row after row
+                        node_costs_;    // Costs of the current node, with its forbidden arcs
+
+    std::vector<int> successors_;       // Column assigned to each row by the current node
     
     std::list<tNode> tree_;
 
@@ -29,13 +38,24 @@ class BB : public Problem{
     void printAssingmentMatrix();
 
     public:
-        BB(double ***matrix_pointer, int dimension);
+        BB(double ***matrix_pointer, int dimension, const tParameters &params = tParameters());
 
-        void printSolution();
+        BB(const Instance &instance, const tParameters &params = tParameters());
+
+        ~BB();
 
-        void printTimes();
+        BB(const BB &) = delete;
+        BB& operator=(const BB &) = delete;
+
+        void configure(const tParameters &params),
+             setInstance(const Instance &instance),
+             solve();
+
+        void printSolution();
 
         double getCost();
+
+        const std::vector<int>& getRoute();
 };
 
 #endif // BB_H
\ No newline at end of file
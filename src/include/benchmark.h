@@ -0,0 +1,71 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+#define BENCHMARK_REPETITIONS 10        // Default runs of each instance in benchmark mode
+#define BENCHMARK_OPTIMA "instances/optima.txt" // Default table of known optimal costs
+#define REGRESSION_THRESHOLD 5          // Default increase (%) of a baseline value flagged as a regression
+#define REGRESSION_MIN_TIME 0.05        // Mean times (s) shorter than this are too noisy to be compared
+#define ANYTIME_POINTS 50               // Log-spaced times the anytime quality curves are sampled at
+
+// A structure that stores the outcome of a single benchmark run
+struct tRun{
+    unsigned seed;
+    double cost,
+           gap,     // Gap (%) to the known optimum, or to the solver's lower bound, NAN if there is neither
+           wall,    // Seconds
+           cpu;     // Seconds of processor time
+    std::vector<double> phases; // Seconds spent in each timer slot
+    std::vector<std::vector<uint64_t>> counts; // Perf event counts of each timer slot, empty if they are off
+    std::vector<std::string> labels;    // Label of each timer slot
+    std::vector<std::pair<double, double>> trajectory; // Time (s) and cost of every incumbent
+};
+
+// A structure that stores the minimum, mean, median and sample standard deviation of a value over the runs
+struct tStatistics{
+    double min, mean, median, stdev;
+};
+
+// A structure that summarizes the runs of a benchmark instance
+struct tSummary{
+    std::string instance,   // File name without the extension
+                mode;
+    int dimension,
+        runs;
+    unsigned seed;          // Seed of the first run, the others follow it
+    double optimum;         // NAN if unknown
+    tStatistics cost, gap, wall, cpu;
+    std::vector<std::pair<std::string, double>> phases; // Mean seconds of every labeled timer slot
+    std::vector<std::vector<uint64_t>> counts;          // Mean perf event counts of each of them, if they are on
+};
+
+// Expands the instance arguments, which may be glob patterns or, with a leading @, files listing one per line
+std::vector<std::string> expandInstances(const std::vector<std::string> &arguments);
+
+// Reads a "name cost" table of known optimal costs, lines starting with # are comments
+std::map<std::string, double> readOptima(const char *path);
+
+std::string instanceName(const std::string &path);
+
+tSummary summarize(const std::string &path, const std::string &mode, int dimension, unsigned seed, double optimum,
+                   const std::vector<std::string> &labels, const std::vector<tRun> &runs);
+
+void printSummary(std::ostream &out, const tSummary &summary);
+
+// Writes the summaries as JSON if the path ends with .json and as CSV otherwise
+bool writeReport(const char *path, const std::vector<tSummary> &summaries);
+
+// Writes the runs of every instance as CSV to <prefix>-trajectories.csv (every incumbent of every run),
+// <prefix>-ttt.csv (time to target distributions) and <prefix>-anytime.csv (mean cost over time)
+bool writeCurves(const char *prefix, const std::vector<tSummary> &summaries, const std::vector<std::vector<tRun>> &runs);
+
+// Compares the summaries with a CSV report of an earlier build and prints every mean cost or wall time that grew by
+// more than the threshold (%). Returns the number of regressions
+int compareBaseline(std::ostream &out, const char *path, const std::vector<tSummary> &summaries, double threshold);
+
+#endif // BENCHMARK_H
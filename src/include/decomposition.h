@@ -0,0 +1,34 @@
+#ifndef DECOMPOSITION_H
+#define DECOMPOSITION_H
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include "structures.h"
+#include "thread_pool.h"
+
+#define DECOMPOSITION_STAGNATION 25 // Default ILS iterations without improvement of each subproblem
+#define DECOMPOSITION_IDLE 2        // Rounds in a row without improvement before the decomposition stops
+
+// Optimizes a TSP route by segments: each one is solved as a path with fixed ends by a TSP over its nodes only,
+// and the segments of a round are solved in parallel since they only share their ends
+class Decomposition{
+    double **matrix_;
+    int dimension_,
+        segment_;           // Nodes per segment
+    tParameters params_;    // Parameters of the subproblems
+    ThreadPool pool_;
+    std::mt19937 rng_;      // Draws the seeds of the subproblems
+
+    double optimizeSegment(std::vector<int> &tour, int first, int last, unsigned seed,
+                           std::chrono::steady_clock::time_point deadline);
+
+    public:
+        Decomposition(double **matrix, int dimension, const tParameters &params, unsigned seed);
+
+        // The segments still waiting for a worker at the deadline are left as they are
+        double round(std::vector<int> &route, int offset,
+                     std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+};
+
+#endif // DECOMPOSITION_H
@@ -0,0 +1,41 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <string>
+#include <vector>
+#include "structures.h"
+
+// A class that owns an instance: its distance matrix and, for the planar weight types, the coordinates of its nodes.
+// The solvers keep pointers to them, so an instance must outlive the solves that read it
+class Instance{
+    double **matrix_;
+    double *x_, *y_;    // NULL when the instance has no coordinates
+    int dimension_;
+    bool asymmetric_;
+
+    public:
+        // Reads a TSPLIB file
+        Instance(const std::string &path);
+
+        // A Euclidean instance (EUC_2D, distances rounded to the nearest integer) over the given coordinates
+        Instance(const std::vector<double> &x, const std::vector<double> &y);
+
+        ~Instance();
+
+        Instance(const Instance &) = delete;
+        Instance& operator=(const Instance &) = delete;
+
+        double** getMatrix() const;
+
+        const double *getX() const,
+                     *getY() const;
+
+        int getDimension() const;
+
+        bool isAsymmetric() const;
+
+        // Sets the fields of the parameters that describe the instance: the coordinates and asymmetric
+        void apply(tParameters &params) const;
+};
+
+#endif // INSTANCE_H
@@ -0,0 +1,78 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <cstdint>
+#include <ostream>
+#include "timer.h"
+
+#ifndef INSTRUMENTATION
+#define INSTRUMENTATION 1 // Build with INSTRUMENTATION=0 to compile the counters out
+#endif
+
+#define LATENCY_BUCKETS 40 // Bucket b of a latency histogram counts the calls of [2^b, 2^(b+1)) nanoseconds
+
+// A structure that stores the counters of a timer slot (a neighborhood, the construction, ...)
+struct tCounters{
+    long calls,
+         improving,             // Calls that improved the solution
+         evaluated;             // Moves evaluated
+    double gain;                // Total cost decrease
+    long latency[LATENCY_BUCKETS];
+};
+
+// A structure that stores the counters of every timer slot of a solver
+struct tInstrumentation{
+    bool enabled;
+    tCounters slots[TIMER_SLOTS];
+};
+
+// Collects the counters of a solver. The disabled specialization does nothing, so its calls compile out
+template <bool Enabled>
+class Instrumentation{
+    tInstrumentation data_ = {true, {}};
+    long evaluated_ = 0; // Moves evaluated since the last record
+
+    public:
+        void evaluate(long moves){
+            evaluated_ += moves;
+        }
+
+        // Adds a call of the slot that took the given nanoseconds, along with the moves evaluated since the last one
+        void record(int slot, bool improved, double gain, int64_t nanoseconds){
+            tCounters &counters = data_.slots[slot];
+            int bucket = nanoseconds > 0 ? 63 - __builtin_clzll(nanoseconds) : 0;
+
+            counters.calls++;
+            counters.improving += improved;
+            counters.gain += gain;
+            counters.evaluated += evaluated_;
+            counters.latency[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS-1]++;
+            evaluated_ = 0;
+        }
+
+        const tInstrumentation& get() const{
+            return data_;
+        }
+};
+
+template <>
+class Instrumentation<false>{
+    tInstrumentation data_ = {false, {}};
+
+    public:
+        void evaluate(long moves){}
+
+        void record(int slot, bool improved, double gain, int64_t nanoseconds){}
+
+        const tInstrumentation& get() const{
+            return data_;
+        }
+};
+
+// Returns the nanoseconds below which the given fraction of the calls of the slot fall, up to a power of 2
+int64_t latencyPercentile(const tCounters &counters, double fraction);
+
+// Prints the counters of a slot after its time, if they were collected
+void printCounters(std::ostream &out, const tCounters &counters, double seconds);
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,32 @@
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+#include <vector>
+#include <queue>
+
+// A 2-d tree over a set of planar points. The range [lo, hi) of the tree order has its splitting node
+// at (lo+hi)/2, so no pointers are needed. Nodes can be removed, which prunes the ranges left empty
+class KDTree{
+    const double *x_, *y_;
+
+    std::vector<int> order_,    // Nodes in tree order
+                     position_, // Index of each node in order_
+                     alive_;    // Number of active nodes of the range split at each index
+
+    std::vector<char> axis_,    // Splitting axis of the range split at each index: 0 for x, 1 for y
+                      active_;
+
+    void build(int lo, int hi),
+         search(int lo, int hi, double px, double py, int skip, int k,
+                std::priority_queue<std::pair<double, int>> &heap) const;
+
+    public:
+        KDTree(const double *x, const double *y, const std::vector<int> &nodes);
+
+        void nearest(int node, int k, std::vector<int> &result) const,
+             remove(int node);
+
+        int nearest(int node) const;
+};
+
+#endif // KD_TREE_H
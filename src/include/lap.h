@@ -0,0 +1,53 @@
+#ifndef LAP_H
+#define LAP_H
+
+#include <vector>
+#include <cstdint>
+
+#define LAP_EPSILON 1e-9 // Reduced costs closer than this tie in the row reduction, as with the rounding of double costs
+
+// A class that solves square linear assignment problems by the Jonker-Volgenant algorithm: column reduction, two
+// passes of augmenting row reduction and then shortest augmenting paths for the rows still free. The costs are a
+// contiguous row-major matrix of doubles or 64-bit integers, taken as they are. The workspace is allocated once
+// per dimension and kept between the solves
+template <typename T>
+class LinearAssignment{
+    int dimension_;
+
+    std::vector<int> columns_,      // Column assigned to each row, the solution
+                     rows_,         // Row assigned to each column
+                     free_,         // Rows left free by the reductions
+                     matches_,      // Columns whose minimum lies on each row
+                     scan_,         // Columns ordered by the state of the shortest path search
+                     predecessors_; // Row reaching each column on the shortest path tree
+
+    std::vector<T> row_duals_,
+                   column_duals_,
+                   distances_;      // Reduced distances of the shortest path search
+
+    void reduceColumns(const T *costs),
+         reduceRows(const T *costs),
+         augment(const T *costs, int row);
+
+    public:
+        LinearAssignment(int dimension = 0);
+
+        void resize(int dimension);
+
+        // Solves the assignment of a dimension x dimension matrix, row after row, and returns the optimal cost
+        T solve(const T *costs);
+
+        int getDimension() const;
+
+        // Column assigned to each row by the last solve
+        const std::vector<int>& getAssignment() const;
+
+        // Optimal duals of the last solve: u_i + v_j <= c_ij for every cell, with equality on the assigned ones
+        const std::vector<T>& getRowDuals() const,
+                            & getColumnDuals() const;
+};
+
+extern template class LinearAssignment<double>;
+extern template class LinearAssignment<int64_t>;
+
+#endif // LAP_H
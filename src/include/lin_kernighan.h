@@ -0,0 +1,65 @@
+#ifndef LIN_KERNIGHAN_H
+#define LIN_KERNIGHAN_H
+
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <functional>
+#include "tour.h"
+
+#define IMPROVEMENT_EPSILON 1e-7
+#define LK_DEPTH 10         // Most 2-opt moves chained into a single move
+#define LK_BREADTH 5        // Alternatives tried for the first 2-opt move of a chain
+#define LK_SEGMENT 3        // Longest segment moved by the Or-opt moves
+#define LK_MIN_DIMENSION 8  // Smaller tours are left to the RVND
+
+// A local search engine that works on a tour representation instead of the route vector
+class LocalSearch{
+    public:
+        virtual ~LocalSearch(){}
+
+        // Improves the route in place and returns the cost change. When a reference route is given,
+        // only the nodes whose edges differ from it start active
+        virtual double optimize(std::vector<int> &route, const std::vector<int> *reference = NULL) = 0;
+};
+
+// Lin-Kernighan over the candidate lists: variable-depth chains of 2-opt moves (so 3-opt and deeper
+// sequential moves are reached through their 2-opt steps) followed by Or-opt segment insertions, with don't-look bits
+template <class Tour>
+class LinKernighan : public LocalSearch{
+    // A 2-opt move as given to move(), kept so the chain can be undone
+    struct tFlip{
+        int a, b, c, d;
+    };
+
+    Tour tour_;
+
+    double **matrix_;
+    const std::vector<std::vector<int>> &neighbors_;
+    std::function<bool()> time_up_;
+    int dimension_;
+
+    std::deque<int> queue_;
+    std::vector<char> active_,
+                      marked_;      // Nodes already used by the current chain
+    std::vector<int> marked_list_,
+                     reference_next_,
+                     reference_prev_;
+    std::vector<tFlip> flips_;
+
+    void activate(int node),
+         move(int a, int b, int c, int d),
+         undo(int depth),
+         mark(int node),
+         unmark();
+
+    double chain(int t1),
+           orOpt(int a);
+
+    public:
+        LinKernighan(double **matrix, const std::vector<std::vector<int>> &neighbors, int dimension, std::function<bool()> time_up);
+
+        double optimize(std::vector<int> &route, const std::vector<int> *reference = NULL);
+};
+
+#endif // LIN_KERNIGHAN_H
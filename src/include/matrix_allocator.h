@@ -0,0 +1,14 @@
+#ifndef MATRIX_ALLOCATOR_H
+#define MATRIX_ALLOCATOR_H
+
+#include <cstddef>
+
+#define HUGE_PAGE_SIZE (2 << 20) // Size of the huge pages the matrix is aligned to
+
+// Allocates a rows x cols matrix as one contiguous block, on huge pages when the system has them and interleaved
+// over the NUMA nodes when there is more than one, with the row pointers into it
+extern double **allocateMatrix( int rows, int cols );
+
+extern void freeMatrix( double **matrix, int rows, int cols );
+
+#endif // MATRIX_ALLOCATOR_H
@@ -1,30 +1,188 @@
 #ifndef MH_PROBLEM_H
 #define MH_PROBLEM_H
 
+#include <random>
 #include "problem.h"
+#include "kd_tree.h"
 
 #define SUBTOUR_SIZE 3
-#define NEIGHBORLIST_SIZE 5
-#define DEFAULT_NEIGHBORLIST {1, 2, 3, 4, 5}
+#define OROPT_MAX 8 // Longest Or-opt segment the neighborhoods are generated for
+#define CACHE_REBUILD 4 // A move cache is rebuilt once more than 1/CACHE_REBUILD of the route changed
+#define ADAPTIVE_EPSILON 0.1 // Chance of the adaptive RVND picking a neighborhood uniformly
+#define ADAPTIVE_DECAY 0.95  // Weight of the past searches of a neighborhood after each new one
+#define HILBERT_SIDE (1 << 16) // Cells per side of the grid the Hilbert curve is laid over
+#define GREEDY_NOISE 0.1     // Largest relative noise added to the edge costs by the greedy edge construction
+#define NN_CANDIDATES 2      // Nearest unvisited nodes the nearest neighbor construction picks from
+#define PERTURB_BASE 3       // Longest segment of the adaptive double bridge right after an improvement
+#define PERTURB_STEP 10      // ILS iterations without improvement that lengthen its segments by one node
 
 class MetaheuristicProblem : public Problem{
     protected:
         std::vector<int> candidate_list_;
 
-        virtual void perturb() = 0;
+        std::vector<std::vector<int>> neighbors_; // The nearest nodes of each node
 
-        virtual bool swap() = 0,
-                     revert() = 0,
-                     reinsert(int num) = 0;
+        std::vector<int> changed_,          // Positions of the route that differ from the cached one
+                         changed_count_,    // Number of changed positions before each position
+                         positions_;        // Position of each node in the route the local double bridge last indexed
 
-        int random(int num) const;
+        std::vector<tNeighborhoodStats> stats_;
+
+        mutable std::mt19937 rng_; // Each solver has its own generator, so they can run in parallel
+
+        virtual void perturb(int stagnation) = 0;
+
+        virtual bool searchNeighborhood(int index) = 0;
+
+        virtual double getCurrentCost() = 0;
+
+        void reset();
+
+        void rvnd(int neighborhoods),
+             buildNeighbors(int k),
+             fastRoute(char construction, int first, std::vector<int> &route),
+             hilbertRoute(std::vector<int> &route),
+             greedyRoute(std::vector<int> &route),
+             nearestNeighborRoute(int first, std::vector<int> &route),
+             bridgeSegments(const std::vector<int> &route, int stagnation, int &i, int &i_size, int &j, int &j_size),
+             swapSegments(std::vector<int> &route, int i, int i_size, int j, int j_size);
+
+        int random(int num) const,
+            adaptiveChoice(const std::vector<int> &neighbor_list);
+
+        template <class Columns, class Delta>
+        tMove<double> cachedSearch(tMoveCache &cache, const std::vector<int> &route, const tFootprint &footprint,
+                                   int first_row, int last_row, Columns columns, Delta delta);
         
     public:
-        MetaheuristicProblem(double ***matrix_pointer, int dimension);
+        MetaheuristicProblem(double ***matrix_pointer, int dimension, const tParameters &params = tParameters());
+
+        MetaheuristicProblem(const Instance &instance, const tParameters &params = tParameters());
 
-        void printTimes();
+        void configure(const tParameters &params),
+             setInstance(const Instance &instance);
 
         virtual double getRealCost() = 0;
 };
 
+// A function that searches for the move (i,j) with the lowest delta, i in [first_row, last_row) and j in the
+// [first, last) pair returned by columns(i). Only the rows and columns whose footprint holds a position changed
+// since the last search are evaluated again, the other ones keep their cached best move
+template <class Columns, class Delta>
+tMove<double> MetaheuristicProblem::cachedSearch(tMoveCache &cache, const std::vector<int> &route, const tFootprint &footprint,
+                                                 int first_row, int last_row, Columns columns, Delta delta){
+    int size = route.size();
+    bool full = !params_.move_cache || cache.route.size() != size;
+    tMove<double> best = {0, 0, INFINITY};
+
+    if(!full){
+        changed_.clear();
+        changed_count_.resize(size+1);
+        changed_count_[0] = 0;
+
+        for(int k = 0; k < size; k++){
+            if(cache.route[k] != route[k])
+                changed_.push_back(k);
+            changed_count_[k+1] = changed_.size();
+        }
+
+        full = changed_.size() > size / CACHE_REBUILD;
+    }
+
+    cache.route = route;
+    if(full)
+        cache.rows.assign(size, best);
+
+    auto touched = [&](int first, int last) -> bool{
+        first = std::max(first, 0);
+        last = std::min(last, size-1);
+        return first <= last && changed_count_[last+1] - changed_count_[first] > 0;
+    };
+
+    auto scan = [&](int i, int first, int last){
+        instrumentation_.evaluate(std::max(0, last - first));
+        for(int j = first; j < last; j++){
+            double d = delta(i, j);
+            if(d < cache.rows[i].cost)
+                cache.rows[i] = {i, j, d};
+        }
+    };
+
+    for(int i = first_row; i < last_row; i++){
+        std::pair<int, int> range = columns(i);
+        tMove<double> &row = cache.rows[i];
+
+        bool dirty = full || touched(i + footprint.row_first, i + footprint.row_last);
+
+        // The cached best move must still be valid
+        if(!dirty && row.cost < INFINITY){
+            if(footprint.span)
+                dirty = touched(std::min(i + footprint.row_first, row.j + footprint.column_first),
+                                std::max(i + footprint.row_last, row.j + footprint.column_last));
+            else
+                dirty = touched(row.j + footprint.column_first, row.j + footprint.column_last);
+        }
+
+        if(dirty){
+            row = {i, 0, INFINITY};
+            scan(i, range.first, range.second);
+        }
+        else if(!footprint.span){
+            // Only the columns around the changed positions
+            for(int p : changed_)
+                scan(i, std::max(range.first, p - footprint.column_last), std::min(range.second, p - footprint.column_first + 1));
+        }
+        else{
+            // The moves after the row reach a change from the first changed position after it on,
+            // the moves before it up to the last changed position before it
+            std::vector<int>::iterator next = std::lower_bound(changed_.begin(), changed_.end(), i + footprint.row_first);
+
+            if(next != changed_.end())
+                scan(i, std::max(range.first, std::max(i+1, *next - footprint.column_last)), range.second);
+
+            if(next != changed_.begin())
+                scan(i, range.first, std::min(range.second, std::min(i, *(next-1) - footprint.column_first + 1)));
+        }
+
+        if(row.cost < best.cost)
+            best = row;
+    }
+
+    return best;
+}
+
+// Appends the Or-opt neighborhoods for segments of length 1 up to min(Num, max).
+// Each one is a T::reinsert<Num> specialization, so the segment length is known at compile time
+template <class T, int Num>
+struct tOrOptTable{
+    static void fill(std::vector<tNeighborhood<T>> &table, int max){
+        tOrOptTable<T, Num-1>::fill(table, max);
+
+        if(Num <= max)
+            table.push_back({&T::template reinsert<Num>, Num == 1 ? "Or-opt" : "Or-opt" + std::to_string(Num)});
+    }
+};
+
+template <class T>
+struct tOrOptTable<T, 0>{
+    static void fill(std::vector<tNeighborhood<T>> &table, int max){}
+};
+
+// Appends the Or-opt neighborhoods that reinsert the segment reversed, for lengths 2 up to min(Num, max)
+// (a reversed single node is the plain Or-opt). Each one is a T::reinsert<Num, true> specialization
+template <class T, int Num>
+struct tReversedOrOptTable{
+    static void fill(std::vector<tNeighborhood<T>> &table, int max){
+        tReversedOrOptTable<T, Num-1>::fill(table, max);
+
+        if(Num <= max)
+            table.push_back({&T::template reinsert<Num, true>, "Reversed Or-opt" + std::to_string(Num)});
+    }
+};
+
+template <class T>
+struct tReversedOrOptTable<T, 1>{
+    static void fill(std::vector<tNeighborhood<T>> &table, int max){}
+};
+
 #endif // MH_PROBLEM_H
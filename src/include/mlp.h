@@ -8,17 +8,36 @@
 #define LAST route.size()-1
 
 class MLP : public MetaheuristicProblem{
+    template <class T, int Num> friend struct tOrOptTable;
+    friend class KernelBenchmark;
+    friend class NeighborhoodCheck;
+
     tSolution<std::vector<std::vector<tCost>>> s_, best_, final_;
 
-    void perturb(),
+    std::vector<tNeighborhood<MLP>> neighborhoods_;
+
+    double lower_bound_;
+
+    void perturb(int stagnation),
          construction(),
+         computeLowerBound(),
          fillCost(),
-         computeCost(int first, int last),
-         concatenate(tCost &s1, const tCost &s2, int s1_last, int s2_first) const;
+         computeCost(int first, int last);
+
+    // Concatenate two subsequences
+    inline void concatenate(tCost &s1, const tCost &s2, int s1_last, int s2_first) const{
+        s1.c += s2.w*(s1.t + matrix_[s_.route[s1_last]][s_.route[s2_first]]) + s2.c;
+        s1.t += matrix_[s_.route[s1_last]][s_.route[s2_first]] + s2.t;
+        s1.w += s2.w;
+    }
+
+    double getCurrentCost();
 
-    bool swap(),
-         revert(),
-         reinsert(int num);
+    bool swap(tMoveCache &cache),
+         revert(tMoveCache &cache),
+         searchNeighborhood(int index);
+
+    template <int Num> bool reinsert(tMoveCache &cache);
 
     //-----===== Debugging functions =====-----
 
@@ -27,10 +46,19 @@ class MLP : public MetaheuristicProblem{
     //-----===============================-----
 
     public:
-        MLP(double ***matrix_pointer, int dimension);
+        MLP(double ***matrix_pointer, int dimension, const tParameters &params = tParameters());
+
+        MLP(const Instance &instance, const tParameters &params = tParameters());
+
+        void configure(const tParameters &params),
+             setInstance(const Instance &instance),
+             solve();
 
         double getCost(),
-               getRealCost();
+               getRealCost(),
+               getLowerBound();
+
+        const std::vector<int>& getRoute();
 
         void printSolution();
 };
@@ -0,0 +1,13 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "structures.h"
+
+// Returns the value of an option given as "--name=value" or "--name value", or NULL if argv[i] is another option
+char* optionValue(int argc, char** argv, int &i, const char *name);
+
+// Reads argv[i] into the parameters if it is a solver parameter (--time-limit, --stagnation, ...), advancing i past
+// its value. Returns false if it is another option
+bool parameterParse(int argc, char** argv, int &i, tParameters &parameters);
+
+#endif // OPTIONS_H
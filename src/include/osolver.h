@@ -0,0 +1,22 @@
+#ifndef OSOLVER_H
+#define OSOLVER_H
+
+// The solver library (libosolver). An Instance is loaded once and solved by any number of solvers, each one set up
+// once and solved many times:
+//
+//     Instance instance("instances/kroA100.tsp");
+//     TSP solver(instance);
+//
+//     solver.configure(params);   // Optional, the parameters of the next solves
+//     solver.solve();
+//     tResult result = solver.result();
+//
+// A solver keeps its buffers between the solves, and between instances of the same dimension given by setInstance.
+// Different solvers may run on different threads, a single one may not
+
+#include "instance.h"
+#include "tsp.h"
+#include "mlp.h"
+#include "bb.h"
+
+#endif // OSOLVER_H
@@ -0,0 +1,36 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#define PERF_EVENTS 6 // Cycles, instructions, cache misses, dTLB load misses, branch misses and page faults
+
+// Indexes of the counters in the value arrays
+enum { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_DTLB_MISSES, PERF_BRANCH_MISSES, PERF_PAGE_FAULTS };
+
+extern const char *PERF_NAMES[PERF_EVENTS];
+
+// Turns the counters on for every thread, each one opens its own group of perf events on its first read.
+// Without Linux perf events nothing is counted
+void enablePerf();
+
+bool perfEnabled();
+
+// Reads the counts of the calling thread so far, returns false if it has no counters
+bool readPerf(uint64_t values[PERF_EVENTS]);
+
+// Whether the calling thread counts the event, some processors or virtual machines lack some of them
+bool perfAvailable(int event);
+
+// Adds the counts of a phase to the totals of the calling thread
+void addPerfTotals(const std::string &label, const uint64_t values[PERF_EVENTS]);
+
+// Prints the counters of a phase after its time: IPC and the misses per thousand instructions
+void printPerf(std::ostream &out, const uint64_t values[PERF_EVENTS]);
+
+// Prints the totals of every phase of every thread that added some
+void printPerfThreads(std::ostream &out);
+
+#endif // PERF_COUNTERS_H
@@ -6,29 +6,68 @@
 #include <algorithm>
 #include <cmath>
 #include "timer.h"
+#include "instrumentation.h"
+#include "trace.h"
+#include "structures.h"
+#include "instance.h"
 
 class Problem{
     protected:
         double **matrix_;
         int dimension_;
         Timer timer_;
+        Instrumentation<INSTRUMENTATION != 0> instrumentation_;
+        tParameters params_;
 
         void printRoute(std::vector<int> &route);
 
+        bool timeUp(),
+             stop(double cost);
+
+        void newIncumbent(const std::vector<int> &route, double cost, long iteration);
+
+        virtual void reset();
+
     public:
-        Problem(double ***matrix_pointer, int dimension);
+        Problem(double ***matrix_pointer, int dimension, const tParameters &params = tParameters());
+
+        Problem(const Instance &instance, const tParameters &params = tParameters());
+
+        virtual ~Problem() = default;
+
+        // Replaces the parameters of the next solves. The fields that describe the instance are kept
+        virtual void configure(const tParameters &params);
+
+        // Solves the given instance from now on. The buffers of the solver are kept if it has the same dimension
+        virtual void setInstance(const Instance &instance);
+
+        virtual void solve() = 0;
+
+        tResult result();
 
         void printMatrix();
 
-        virtual void printTimes() = 0;
+        virtual void printTimes();
         
         virtual void printSolution() = 0;
 
         virtual double getCost() = 0;
 
+        virtual const std::vector<int>& getRoute() = 0;
+
+        virtual double getLowerBound();
+
+        double getGap();
+
         std::vector<double>* getTimes();
         
         int64_t* getTimerPointer();
+
+        const tInstrumentation& getInstrumentation();
+
+        const std::string& getTimeLabel(int part);
+
+        const uint64_t* getTimeCounts(int part);
 };
 
 #endif // PROBLEM_H
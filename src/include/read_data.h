@@ -1,4 +1,7 @@
 #ifndef READDATA_H_INCLUDED
 #define READDATA_H_INCLUDED
-extern void readData( char* , int* , double *** );
+#include <cstddef>
+extern void readData( char* , int* , double *** , double ** = NULL , double ** = NULL );
+extern bool isAsymmetric( double ** , int );
+extern int readDimension( const char * );
 #endif // READDATA_H_INCLUDED
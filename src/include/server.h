@@ -0,0 +1,43 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <string>
+#include "instance.h"
+
+#define SERVER_CACHE 16     // Default instances the server keeps parsed
+#define SERVER_BACKLOG 64   // Connections waiting to be accepted
+#define SERVER_BUFFER 65536 // Bytes read from a socket at a time
+
+// A least recently used cache of parsed instances, shared by the threads of the server. An instance evicted while
+// a solve still reads it lives on until that solve ends
+class InstanceCache{
+    int capacity_;
+    std::list<std::pair<std::string, std::shared_ptr<Instance>>> entries_; // Most recently used first
+    std::map<std::string, std::list<std::pair<std::string, std::shared_ptr<Instance>>>::iterator> index_;
+    std::mutex mutex_;
+
+    public:
+        InstanceCache(int capacity = SERVER_CACHE);
+
+        // Returns the instance of the file, read on a miss, or NULL if it can't be read. Sets hit if it was cached
+        std::shared_ptr<Instance> get(const std::string &path, bool &hit);
+};
+
+// Listens on a Unix domain socket at the path, replacing a stale one. Returns the socket or -1
+int listenSocket(const char *path);
+
+// Connects to the Unix domain socket at the path. Returns the socket or -1
+int connectSocket(const char *path);
+
+// Writes the whole string to the socket, returns false once the peer is gone
+bool sendAll(int socket, const std::string &data);
+
+// Reads the next line from the socket, without its newline. The bytes received past it are kept in the buffer for the
+// next call. Returns false if the peer closed the socket before a whole line
+bool readLine(int socket, std::string &buffer, std::string &line);
+
+#endif // SERVER_H
@@ -0,0 +1,13 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <ostream>
+#include <string>
+#include "structures.h"
+
+void writeIncumbent(std::ostream &out, const tIncumbent &incumbent, const char *event = "incumbent");
+
+// Returns the text as a quoted JSON string, with its quotes, backslashes and control characters escaped
+std::string jsonString(const std::string &text);
+
+#endif // STREAM_H
@@ -2,6 +2,8 @@
 #define STRUCTURES_H
 
 #include <vector>
+#include <string>
+#include <functional>
 // #include <utility>
 
 // A structure that stores the cost from a certain move involving i and j
@@ -14,6 +16,35 @@ struct tMove{
     }
 };
 
+// A structure that keeps the best move of each row i of a neighborhood between searches,
+// along with the route they were evaluated on
+struct tMoveCache{
+    std::vector<int> route;
+    std::vector<tMove<double>> rows;
+};
+
+// A structure that describes the route positions a move (i,j) reads: [i+row_first, i+row_last] and
+// [j+column_first, j+column_last], plus every position between them if span is set
+struct tFootprint{
+    int row_first, row_last, column_first, column_last;
+    bool span;
+};
+
+// A structure that keeps the decayed cost improvement and search time (ns) of a neighborhood for the adaptive RVND
+struct tNeighborhoodStats{
+    double gain, time;
+    long calls;
+};
+
+// A structure that represents a RVND neighborhood: its search function, the label its time is reported with
+// and the cache of its moves
+template <typename T>
+struct tNeighborhood{
+    bool (T::*search)(tMoveCache &cache);
+    std::string label;
+    tMoveCache cache;
+};
+
 // A structure to store the w, t and c costs (MLP exclusive)
 struct tCost{
     int w;
@@ -28,6 +59,50 @@ struct tSolution{
     T cost;
 };
 
+// A structure that represents a new best solution reported by a solver
+struct tIncumbent{
+    const std::vector<int> *route;
+    double cost;
+    double time;    // Seconds since the solver started
+    long iteration; // ILS iterations (or BB nodes) processed so far
+};
+
+// A structure that stores the outcome of a solve
+struct tResult{
+    std::vector<int> route;
+    double cost,
+           lower_bound, // 0 if the solver doesn't compute one
+           time;        // Seconds the solve took
+};
+
+// A structure that stores the execution parameters shared by the solvers
+struct tParameters{
+    double gap_limit = 0,   // Stops the search once the optimality gap (%) is at most this value
+           time_limit = 0,  // Wall-clock budget in seconds
+           target = 0;      // Stops the search once a solution at least this good is found
+    int stagnation = 0,     // ILS iterations without improvement before a restart
+        restarts = 0,       // Number of GILS restarts (0 keeps the solver default)
+        oropt_max = 3,      // Longest segment moved by the Or-opt neighborhoods
+        neighbors = 8,      // Size of the candidate lists
+        decomposition = 0,  // Nodes per segment of the decomposition mode (TSP only), 0 turns it off
+        threads = 0,        // Worker threads of the decomposition, 0 for one per hardware thread
+        elite = 0;          // Distinct restart optima kept for tour merging (TSP only), 0 turns it off
+    unsigned seed = 0;      // Seed of the solver's random generator, 0 draws one from rand()
+    char tour = 0,          // Tour representation of the candidate list searches: 'a'rray, 'l'ist or 0 to pick by dimension
+         local_search = 'r',// Local search of the ILS: 'r'vnd or 'l'in-Kernighan (TSP only)
+         rvnd = 'c',        // Neighborhood choice of the RVND: 'c'lassic (uniform) or 'a'daptive
+         perturbation = 'c',// Double bridge of the ILS: 'c'lassic, 'a'daptive or 'l'ocal
+         construction = 0,  // Construction of the GILS: 'c'lassic, 'h'ilbert curve, 'g'reedy edge, 'n'earest neighbor or 0 for the solver default
+         assignment = 'j';  // Assignment solver of the BB nodes: 'j'onker-Volgenant or 'h'ungarian
+    bool move_cache = true; // Reuses the move evaluations the last changes of the route didn't touch
+    bool quiet = false,     // Doesn't print the new minimums
+         asymmetric = false;// The matrix has arcs whose opposite arc costs differ
+    const double *x = NULL, // Planar coordinates of the nodes, NULL when the instance has none
+                 *y = NULL;
+    const std::vector<int> *initial = NULL; // Route the first restart starts from instead of a construction (TSP only)
+    std::function<void(const tIncumbent &)> observer; // Called with every new incumbent
+};
+
 // A structure that represents a BB node
 struct tNode{
     std::vector<std::pair<int,int>> forbidden;
@@ -0,0 +1,36 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// A fixed set of worker threads that run the submitted tasks in order of arrival
+class ThreadPool{
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+
+    std::mutex mutex_;
+    std::condition_variable work_,  // Signals a new task or the shutdown to the workers
+                            done_;  // Signals the last pending task finishing to wait()
+
+    int pending_;   // Submitted tasks not finished yet
+    bool stopping_;
+
+    void work();
+
+    public:
+        ThreadPool(int threads = 0);
+
+        ~ThreadPool();
+
+        void submit(std::function<void()> task),
+             wait();
+
+        int size() const;
+};
+
+#endif // THREAD_POOL_H
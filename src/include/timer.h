@@ -2,33 +2,63 @@
 #define TIMER_H
 
 #include <chrono>
+#include <string>
+#include <cstdint>
+#include "perf_counters.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define TIMER_SLOTS 32
+#define TIMER_TOTAL (TIMER_SLOTS-1) // The last slot stores the total execution time
+#define TICK_CALIBRATION 2000000    // Nanoseconds the time stamp counter is measured against the steady clock
 
 using namespace std::chrono;
 
+// Reads the time stamp counter, or the steady clock in nanoseconds on processors without one
+inline int64_t readTicks(){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
 class Timer{
-    high_resolution_clock::time_point t0, t1, totalT0, totalT1;  //Variables used to measure the time delta
+    int64_t starts[TIMER_SLOTS],    // Ticks at which each running slot started
+            totalStart;
+
+    int64_t durations[TIMER_SLOTS] = {}; // Nanoseconds
+
+    bool running[TIMER_SLOTS] = {};
 
-    int64_t durations[7] = {};
+    uint64_t counts[TIMER_SLOTS][PERF_EVENTS] = {},   // Perf event counts of each slot, if they are enabled
+             startCounts[TIMER_SLOTS][PERF_EVENTS];
 
-    bool hasRun;
+    std::string labels[TIMER_SLOTS];
 
     public:
         Timer();
-        
-        void setTime(char part),
-             setTotalTime(),
+
+        static double tickLength();
+
+        int64_t setTime(int part);
+
+        void setLabel(int part, const std::string &label),
              stop();
 
-        double getConstructionTime(),
-               getSwapTime(),
-               getRevertTime(),
-               getReinsertion1Time(),
-               getReinsertion2Time(),
-               getReinsertion3Time(),
-               getTotalTime();
+        double getTime(int part),
+               getConstructionTime(),
+               getTotalTime(),
+               getElapsedTime();
+
+        const std::string& getLabel(int part);
 
         int64_t* getPointer();
+
+        const uint64_t* getCounts(int part);
 };
 
 
-#endif // TIMER_H
\ No newline at end of file
+#endif // TIMER_H
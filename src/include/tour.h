@@ -0,0 +1,105 @@
+#ifndef TOUR_H
+#define TOUR_H
+
+#include <vector>
+
+#define TWOLEVEL_DIMENSION 1000 // Smallest dimension the two-level list is used for by default
+
+// Tour representations used by the candidate list searches. Both expose the same operations:
+//  next(a), prev(a): the neighbors of a in the current orientation
+//  between(a, b, c): true if b is met when going forward from a to c
+//  flip(a, b, c, d): with b = next(a) and d = next(c), replaces the edges (a,b) and (c,d) by (a,c) and (b,d).
+//                    Either side of the tour may be reversed, so the orientation must be queried again afterwards
+
+// The tour as an array plus the position of each node. Flips cost O(N)
+class ArrayTour{
+    std::vector<int> order_, position_;
+
+    int dimension_;
+
+    void reverse(int first, int last);
+
+    public:
+        ArrayTour(int dimension);
+
+        void build(const std::vector<int> &route),
+             getRoute(std::vector<int> &route, int start) const,
+             flip(int a, int b, int c, int d);
+
+        inline int next(int a) const{
+            return order_[position_[a]+1 == dimension_ ? 0 : position_[a]+1];
+        }
+
+        inline int prev(int a) const{
+            return order_[position_[a] == 0 ? dimension_-1 : position_[a]-1];
+        }
+
+        bool between(int a, int b, int c) const;
+};
+
+// The tour split into about sqrt(N) segments, each one a doubly-linked list with a reversal bit.
+// Flips cost O(sqrt(N)): whole segments are reversed by toggling their bit and at most two are split
+class TwoLevelTour{
+    // A structure that represents a segment of the tour
+    struct tSegment{
+        bool reversed;
+        int first, last; // Ends of the segment in its own direction
+        int next, prev;  // Neighbor segments in tour order
+        int rank;        // Position of the segment in tour order
+    };
+
+    std::vector<tSegment> segments_;
+
+    std::vector<int> parent_, // Segment of each node
+                     seq_,    // Order of each node inside its segment, in the segment's own direction
+                     next_,
+                     prev_,
+                     buffer_; // Scratch space for the reversals
+
+    int dimension_,
+        group_size_,
+        head_;          // Segment ranked first
+
+    void rank(),
+         split(int node, bool before),
+         reverseInside(int b, int c),
+         reverseSegments(int first, int last);
+
+    inline int head(int s) const{
+        return segments_[s].reversed ? segments_[s].last : segments_[s].first;
+    }
+
+    inline int tail(int s) const{
+        return segments_[s].reversed ? segments_[s].first : segments_[s].last;
+    }
+
+    inline long position(int a) const{
+        const tSegment &s = segments_[parent_[a]];
+        return (long)s.rank * (group_size_+1) + (s.reversed ? group_size_ - seq_[a] : seq_[a]);
+    }
+
+    public:
+        TwoLevelTour(int dimension);
+
+        void build(const std::vector<int> &route),
+             getRoute(std::vector<int> &route, int start) const,
+             flip(int a, int b, int c, int d);
+
+        inline int next(int a) const{
+            const tSegment &s = segments_[parent_[a]];
+            if(!s.reversed)
+                return a == s.last ? head(s.next) : next_[a];
+            return a == s.first ? head(s.next) : prev_[a];
+        }
+
+        inline int prev(int a) const{
+            const tSegment &s = segments_[parent_[a]];
+            if(!s.reversed)
+                return a == s.first ? tail(s.prev) : prev_[a];
+            return a == s.last ? tail(s.prev) : next_[a];
+        }
+
+        bool between(int a, int b, int c) const;
+};
+
+#endif // TOUR_H
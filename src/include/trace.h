@@ -0,0 +1,28 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+#define TRACE_MAX_EVENTS (1 << 22) // Events kept per thread, the later ones are dropped
+
+// A structure that represents the begin or the end of a traced span
+struct tTraceEvent{
+    const char *name;   // Interned, valid until the process ends
+    int64_t ticks;
+    char phase;         // 'B'egin or 'E'nd
+};
+
+// Turns the tracing on. Each thread appends its events to its own buffer, without locks
+void enableTrace();
+
+bool traceEnabled();
+
+void traceBegin(const std::string &name),
+     traceEnd(const std::string &name);
+
+// Writes the events of every thread as Chrome trace event JSON, which Perfetto and chrome://tracing open.
+// The threads that recorded them must have finished or be waited for
+bool writeTrace(const char *path);
+
+#endif // TRACE_H
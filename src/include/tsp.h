@@ -2,31 +2,71 @@
 #define TSP_H
 
 #include "metaheuristic_problem.h"
+#include "lin_kernighan.h"
+#include "decomposition.h"
 #include "structures.h"
 
 #define TSP_IMAX 50
+#define DESCENT_DIMENSION 500 // Smallest dimension a candidate list 2-opt descent follows the construction
+#define CONSTRUCTION_DIMENSION 1000 // Smallest dimension the greedy edge construction replaces the cheapest insertion by default
 
 class TSP : public MetaheuristicProblem{
+    template <class T, int Num> friend struct tOrOptTable;
+    template <class T, int Num> friend struct tReversedOrOptTable;
+    friend class KernelBenchmark;
+
     tSolution<double> s_, best_, final_;
 
-    void perturb(),
+    std::vector<tNeighborhood<TSP>> neighborhoods_;
+
+    std::vector<double> forward_, backward_; // Prefix sums of the route cost in each direction, for asymmetric matrices
+
+    std::vector<tSolution<double>> elite_;  // The best distinct restart optima, cheapest first
+
+    void perturb(int stagnation),
          subtour(),
-         initialRoute();
+         initialRoute(),
+         updatePrefixSums(),
+         decompose();
+
+    bool updateElite(const tSolution<double> &solution),
+         mergeElite();
+
+    bool swap(tMoveCache &cache),
+         searchNeighborhood(int index);
 
-    bool swap(),
-         revert(),
-         reinsert(int num);
+    template <bool Asymmetric> bool revert(tMoveCache &cache);
+    template <bool Asymmetric> bool or2h(tMoveCache &cache);
+    template <bool Asymmetric> std::pair<double, double> or2hDeltas(int i, int j);
 
-    double getSolutionCost(tSolution<double> &solution);
+    template <int Num, bool Reversed = false> bool reinsert(tMoveCache &cache);
+
+    // Cost change of reversing the path between the positions i and j of the route
+    inline double reversalDelta(int i, int j) const{
+        return (backward_[j] - backward_[i]) - (forward_[j] - forward_[i]);
+    }
+
+    template <class Tour> void twoOptDescent();
+
+    double getSolutionCost(tSolution<double> &solution),
+           getCurrentCost();
 
     public:
-        TSP(double ***matrix_pointer, int dimension, int iterations = TSP_IMAX);
+        TSP(double ***matrix_pointer, int dimension, const tParameters &params = tParameters());
+
+        TSP(const Instance &instance, const tParameters &params = tParameters());
+
+        void configure(const tParameters &params),
+             setInstance(const Instance &instance),
+             solve();
 
         tSolution<double> getSolution();
 
         double getCost(),
                getRealCost();
 
+        const std::vector<int>& getRoute();
+
         void printSolution();
 };
 
@@ -0,0 +1,60 @@
+#include "include/instance.h"
+#include "include/read_data.h"
+#include "include/matrix_allocator.h"
+
+#include <cmath>
+#include <algorithm>
+
+Instance::Instance(const std::string &path){
+    std::string name = path;
+
+    readData(&name[0], &dimension_, &matrix_, &x_, &y_);
+    asymmetric_ = ::isAsymmetric(matrix_, dimension_);
+}
+
+Instance::Instance(const std::vector<double> &x, const std::vector<double> &y){
+    dimension_ = std::min(x.size(), y.size());
+    matrix_ = allocateMatrix(dimension_, dimension_);
+    x_ = new double[dimension_];
+    y_ = new double[dimension_];
+    asymmetric_ = false;
+
+    std::copy(x.begin(), x.begin() + dimension_, x_);
+    std::copy(y.begin(), y.begin() + dimension_, y_);
+
+    for(int i = 0; i < dimension_; i++)
+        for(int j = 0; j < dimension_; j++)
+            matrix_[i][j] = std::floor(std::hypot(x_[i] - x_[j], y_[i] - y_[j]) + 0.5);
+}
+
+Instance::~Instance(){
+    freeMatrix(matrix_, dimension_, dimension_);
+    delete[] x_;
+    delete[] y_;
+}
+
+double** Instance::getMatrix() const{
+    return matrix_;
+}
+
+const double* Instance::getX() const{
+    return x_;
+}
+
+const double* Instance::getY() const{
+    return y_;
+}
+
+int Instance::getDimension() const{
+    return dimension_;
+}
+
+bool Instance::isAsymmetric() const{
+    return asymmetric_;
+}
+
+void Instance::apply(tParameters &params) const{
+    params.x = x_;
+    params.y = y_;
+    params.asymmetric = asymmetric_;
+}
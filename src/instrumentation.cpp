@@ -0,0 +1,25 @@
+#include "include/instrumentation.h"
+
+int64_t latencyPercentile(const tCounters &counters, double fraction){
+    long seen = 0;
+
+    for(int b = 0; b < LATENCY_BUCKETS; b++){
+        seen += counters.latency[b];
+        if(seen > 0 && seen >= fraction * counters.calls)
+            return (int64_t)2 << b;
+    }
+
+    return 0;
+}
+
+void printCounters(std::ostream &out, const tCounters &counters, double seconds){
+    if(counters.calls == 0)
+        return;
+
+    out << " | " << counters.calls << " calls, " << counters.improving << " improving, gain " << counters.gain;
+
+    if(counters.evaluated > 0)
+        out << ", " << counters.evaluated << " moves (" << seconds * 1e9 / counters.evaluated << " ns/move)";
+
+    out << ", p50 < " << latencyPercentile(counters, 0.5) << " ns, p99 < " << latencyPercentile(counters, 0.99) << " ns";
+}
@@ -0,0 +1,132 @@
+#include "include/kd_tree.h"
+
+#include <algorithm>
+
+KDTree::KDTree(const double *x, const double *y, const std::vector<int> &nodes): x_(x), y_(y), order_(nodes),
+alive_(nodes.size()), axis_(nodes.size()){
+    int size = 0;
+
+    for(int node : nodes)
+        size = std::max(size, node+1);
+
+    position_.assign(size, -1);
+    active_.assign(size, false);
+
+    build(0, order_.size());
+
+    for(int k = 0; k < order_.size(); k++){
+        position_[order_[k]] = k;
+        active_[order_[k]] = true;
+    }
+}
+
+// Splits the range on the axis with the largest spread, by the median
+void KDTree::build(int lo, int hi){
+    if(lo >= hi)
+        return;
+
+    int mid = (lo + hi) / 2;
+    double min_x = x_[order_[lo]], max_x = min_x,
+           min_y = y_[order_[lo]], max_y = min_y;
+
+    for(int k = lo+1; k < hi; k++){
+        min_x = std::min(min_x, x_[order_[k]]);
+        max_x = std::max(max_x, x_[order_[k]]);
+        min_y = std::min(min_y, y_[order_[k]]);
+        max_y = std::max(max_y, y_[order_[k]]);
+    }
+
+    axis_[mid] = max_y - min_y > max_x - min_x;
+    alive_[mid] = hi - lo;
+
+    const double *coordinate = axis_[mid] ? y_ : x_;
+    std::nth_element(order_.begin() + lo, order_.begin() + mid, order_.begin() + hi,
+        [&](int a, int b) -> bool{
+            return coordinate[a] < coordinate[b];
+        }
+    );
+
+    build(lo, mid);
+    build(mid+1, hi);
+}
+
+// Keeps in the heap the k active nodes closest to (px, py), other than skip
+void KDTree::search(int lo, int hi, double px, double py, int skip, int k,
+                    std::priority_queue<std::pair<double, int>> &heap) const{
+    if(lo >= hi)
+        return;
+
+    int mid = (lo + hi) / 2, node = order_[mid];
+
+    if(!alive_[mid])
+        return;
+
+    if(active_[node] && node != skip){
+        double distance = (x_[node]-px)*(x_[node]-px) + (y_[node]-py)*(y_[node]-py);
+
+        if(heap.size() < k)
+            heap.push({distance, node});
+        else if(distance < heap.top().first){
+            heap.pop();
+            heap.push({distance, node});
+        }
+    }
+
+    double diff = axis_[mid] ? py - y_[node] : px - x_[node];
+
+    // The side of the query point first, the other one only if it may hold a closer node
+    if(diff < 0){
+        search(lo, mid, px, py, skip, k, heap);
+        if(heap.size() < k || diff*diff < heap.top().first)
+            search(mid+1, hi, px, py, skip, k, heap);
+    }
+    else{
+        search(mid+1, hi, px, py, skip, k, heap);
+        if(heap.size() < k || diff*diff < heap.top().first)
+            search(lo, mid, px, py, skip, k, heap);
+    }
+}
+
+// Writes the k active nodes closest to the given one, closest first
+void KDTree::nearest(int node, int k, std::vector<int> &result) const{
+    std::priority_queue<std::pair<double, int>> heap;
+
+    search(0, order_.size(), x_[node], y_[node], node, k, heap);
+
+    result.resize(heap.size());
+    for(int i = heap.size()-1; i >= 0; i--){
+        result[i] = heap.top().second;
+        heap.pop();
+    }
+}
+
+// Returns the active node closest to the given one, or -1 if there is none
+int KDTree::nearest(int node) const{
+    std::priority_queue<std::pair<double, int>> heap;
+
+    search(0, order_.size(), x_[node], y_[node], node, 1, heap);
+
+    return heap.empty() ? -1 : heap.top().second;
+}
+
+void KDTree::remove(int node){
+    if(node >= active_.size() || !active_[node])
+        return;
+
+    int lo = 0, hi = order_.size(), target = position_[node];
+
+    active_[node] = false;
+
+    while(true){
+        int mid = (lo + hi) / 2;
+
+        alive_[mid]--;
+        if(mid == target)
+            break;
+
+        if(target < mid)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+}
@@ -0,0 +1,282 @@
+#include "include/lap.h"
+
+#include <limits>
+#include <algorithm>
+#include <utility>
+
+template <typename T>
+LinearAssignment<T>::LinearAssignment(int dimension): dimension_(0){
+    resize(dimension);
+}
+
+template <typename T>
+void LinearAssignment<T>::resize(int dimension){
+    if(dimension == dimension_)
+        return;
+
+    dimension_ = dimension;
+
+    columns_.resize(dimension);
+    rows_.resize(dimension);
+    free_.resize(dimension);
+    matches_.resize(dimension);
+    scan_.resize(dimension);
+    predecessors_.resize(dimension);
+    row_duals_.resize(dimension);
+    column_duals_.resize(dimension);
+    distances_.resize(dimension);
+}
+
+template <typename T>
+int LinearAssignment<T>::getDimension() const{
+    return dimension_;
+}
+
+template <typename T>
+const std::vector<int>& LinearAssignment<T>::getAssignment() const{
+    return columns_;
+}
+
+template <typename T>
+const std::vector<T>& LinearAssignment<T>::getRowDuals() const{
+    return row_duals_;
+}
+
+template <typename T>
+const std::vector<T>& LinearAssignment<T>::getColumnDuals() const{
+    return column_duals_;
+}
+
+// Each column is assigned to the row of its minimum if no column took that row before, the dual of a column is its
+// minimum. The rows matched once then move the slack of their other columns to the dual of the assigned one, and the
+// rows matched by no column are left free
+template <typename T>
+void LinearAssignment<T>::reduceColumns(const T *costs){
+    int n = dimension_;
+
+    std::fill(matches_.begin(), matches_.end(), 0);
+
+    for(int j = n-1; j >= 0; j--){
+        int best = 0;
+
+        for(int i = 1; i < n; i++)
+            if(costs[i*n + j] < costs[best*n + j])
+                best = i;
+
+        column_duals_[j] = costs[best*n + j];
+
+        if(++matches_[best] == 1){
+            columns_[best] = j;
+            rows_[j] = best;
+        }
+        else
+            rows_[j] = -1;
+    }
+
+    int free = 0;
+
+    for(int i = 0; i < n; i++){
+        if(matches_[i] == 0)
+            free_[free++] = i;
+        else if(matches_[i] == 1){
+            const T *row = costs + i*n;
+            int assigned = columns_[i];
+            T slack = std::numeric_limits<T>::max();
+
+            for(int j = 0; j < n; j++)
+                if(j != assigned && row[j] - column_duals_[j] < slack)
+                    slack = row[j] - column_duals_[j];
+
+            column_duals_[assigned] -= slack;
+        }
+    }
+
+    free_.resize(free);
+}
+
+// Two passes over the free rows: each one takes the column of its smallest reduced cost, lowering that column's dual
+// to the second smallest one, and the row it displaces is retried at once. On a tie (within LAP_EPSILON) the row takes
+// the second column instead and the row displaced waits for the next pass. On fractional costs the drops can go on
+// without end, so after k*n of them at the k-th free row the rows take their smallest column without a drop and the
+// displaced ones wait as well, as in the reference LAPJV
+template <typename T>
+void LinearAssignment<T>::reduceRows(const T *costs){
+    int n = dimension_;
+
+    for(int pass = 0; pass < 2; pass++){
+        int previous = free_.size(),
+            free = 0,
+            k = 0;
+        long drops = 0;
+
+        while(k < previous){
+            int i = free_[k++],
+                first = 0,
+                second = -1;
+            const T *row = costs + i*n;
+            T smallest = row[0] - column_duals_[0],
+              next = std::numeric_limits<T>::max();
+
+            for(int j = 1; j < n; j++){
+                T reduced = row[j] - column_duals_[j];
+
+                if(reduced < next){
+                    if(reduced >= smallest){
+                        next = reduced;
+                        second = j;
+                    }
+                    else{
+                        next = smallest;
+                        smallest = reduced;
+                        second = first;
+                        first = j;
+                    }
+                }
+            }
+
+            int displaced = rows_[first];
+            bool tie = next - smallest <= LAP_EPSILON,
+                 retry = !tie && drops < (long)k * n;
+
+            if(retry){
+                column_duals_[first] -= next - smallest;
+                drops++;
+            }
+            else if(tie && displaced >= 0){
+                first = second;
+                displaced = rows_[second];
+            }
+
+            columns_[i] = first;
+            rows_[first] = i;
+
+            if(displaced >= 0){
+                if(retry)
+                    free_[--k] = displaced;
+                else
+                    free_[free++] = displaced;
+            }
+        }
+
+        free_.resize(free);
+    }
+}
+
+// Dijkstra's algorithm on the reduced costs from a free row up to the nearest free column, then the duals of the
+// columns settled before it are raised and the path is flipped. scan_ keeps the settled columns in [0, low), the
+// ones at the minimum distance to be scanned in [low, up) and the rest after them
+template <typename T>
+void LinearAssignment<T>::augment(const T *costs, int start){
+    int n = dimension_,
+        low = 0,
+        up = 0,
+        last = 0,
+        end = -1;
+    const T *row = costs + start*n;
+    T minimum = 0;
+
+    for(int j = 0; j < n; j++){
+        distances_[j] = row[j] - column_duals_[j];
+        predecessors_[j] = start;
+        scan_[j] = j;
+    }
+
+    while(end < 0){
+        if(up == low){
+            last = low;
+            minimum = distances_[scan_[up++]];
+
+            for(int k = up; k < n; k++){
+                int j = scan_[k];
+                T distance = distances_[j];
+
+                if(distance <= minimum){
+                    if(distance < minimum){
+                        up = low;
+                        minimum = distance;
+                    }
+                    scan_[k] = scan_[up];
+                    scan_[up++] = j;
+                }
+            }
+
+            for(int k = low; k < up; k++)
+                if(rows_[scan_[k]] < 0){
+                    end = scan_[k];
+                    break;
+                }
+
+            if(end >= 0)
+                break;
+        }
+
+        int column = scan_[low++],
+            i = rows_[column];
+        const T *current = costs + i*n;
+        T height = current[column] - column_duals_[column] - minimum;
+
+        for(int k = up; k < n; k++){
+            int j = scan_[k];
+            T distance = current[j] - column_duals_[j] - height;
+
+            if(distance < distances_[j]){
+                predecessors_[j] = i;
+                distances_[j] = distance;
+
+                if(distance == minimum){
+                    if(rows_[j] < 0){
+                        end = j;
+                        break;
+                    }
+                    scan_[k] = scan_[up];
+                    scan_[up++] = j;
+                }
+            }
+        }
+    }
+
+    for(int k = 0; k < last; k++){
+        int j = scan_[k];
+        column_duals_[j] += distances_[j] - minimum;
+    }
+
+    int i;
+    do{
+        i = predecessors_[end];
+        rows_[end] = i;
+        std::swap(end, columns_[i]);
+    }while(i != start);
+}
+
+template <typename T>
+T LinearAssignment<T>::solve(const T *costs){
+    int n = dimension_;
+    T cost = 0;
+
+    if(n == 0)
+        return 0;
+
+    if(n == 1){
+        columns_[0] = rows_[0] = 0;
+        row_duals_[0] = costs[0];
+        column_duals_[0] = 0;
+        return costs[0];
+    }
+
+    free_.resize(n);
+    reduceColumns(costs);
+    reduceRows(costs);
+
+    for(int f = 0; f < (int)free_.size(); f++)
+        augment(costs, free_[f]);
+
+    for(int i = 0; i < n; i++){
+        cost += costs[i*n + columns_[i]];
+        row_duals_[i] = costs[i*n + columns_[i]] - column_duals_[columns_[i]];
+    }
+
+    return cost;
+}
+
+template class LinearAssignment<double>;
+template class LinearAssignment<int64_t>;
@@ -0,0 +1,280 @@
+#include "include/lin_kernighan.h"
+
+#include <cmath>
+#include <algorithm>
+
+template <class Tour>
+LinKernighan<Tour>::LinKernighan(double **matrix, const std::vector<std::vector<int>> &neighbors, int dimension, std::function<bool()> time_up):
+tour_(dimension), matrix_(matrix), neighbors_(neighbors), time_up_(time_up), dimension_(dimension),
+active_(dimension), marked_(dimension), reference_next_(dimension), reference_prev_(dimension){}
+
+template <class Tour>
+double LinKernighan<Tour>::optimize(std::vector<int> &route, const std::vector<int> *reference){
+    double total = 0, delta;
+
+    tour_.build(route);
+    queue_.clear();
+
+    if(reference == NULL){
+        for(int i = 0; i < dimension_; i++){
+            active_[route[i]] = true;
+            queue_.push_back(route[i]);
+        }
+    }
+    else{
+        std::fill(active_.begin(), active_.end(), false);
+
+        for(int i = 0; i < dimension_; i++){
+            reference_next_[(*reference)[i]] = (*reference)[i+1];
+            reference_prev_[(*reference)[i+1]] = (*reference)[i];
+        }
+
+        // Only the ends of the new edges need to be looked at
+        for(int i = 0; i < dimension_; i++)
+            if(reference_next_[route[i]] != route[i+1] && reference_prev_[route[i]] != route[i+1]){
+                activate(route[i]);
+                activate(route[i+1]);
+            }
+    }
+
+    while(!queue_.empty() && !time_up_()){
+        int a = queue_.front();
+
+        queue_.pop_front();
+        active_[a] = false;
+
+        delta = chain(a);
+        if(delta >= -IMPROVEMENT_EPSILON)
+            delta = orOpt(a);
+
+        if(delta < -IMPROVEMENT_EPSILON){
+            total += delta;
+            activate(a);
+        }
+    }
+
+    tour_.getRoute(route, route[0]);
+
+    return total;
+}
+
+template <class Tour>
+void LinKernighan<Tour>::activate(int node){
+    if(!active_[node]){
+        active_[node] = true;
+        queue_.push_back(node);
+    }
+}
+
+// Replaces the edges (a,b) and (c,d) by (a,c) and (b,d), where b follows a and d follows c in the same direction
+template <class Tour>
+void LinKernighan<Tour>::move(int a, int b, int c, int d){
+    if(tour_.next(a) == b)
+        tour_.flip(a, b, c, d);
+    else
+        tour_.flip(b, a, d, c);
+}
+
+// Undoes the moves of the chain past the given depth
+template <class Tour>
+void LinKernighan<Tour>::undo(int depth){
+    while(flips_.size() > depth){
+        tFlip &f = flips_.back();
+
+        move(f.a, f.c, f.b, f.d);
+        flips_.pop_back();
+    }
+}
+
+template <class Tour>
+void LinKernighan<Tour>::mark(int node){
+    if(!marked_[node]){
+        marked_[node] = true;
+        marked_list_.push_back(node);
+    }
+}
+
+template <class Tour>
+void LinKernighan<Tour>::unmark(){
+    for(int node : marked_list_)
+        marked_[node] = false;
+
+    marked_list_.clear();
+}
+
+// A function that searches for an improving chain of 2-opt moves starting by removing an edge of t1.
+// Each step removes (t1,t2), adds (t2,t3) and removes (t3,t4), closing the tour with (t4,t1), which is
+// then removed by the next step. Only the prefix of the chain with the best cost is kept
+template <class Tour>
+double LinKernighan<Tour>::chain(int t1){
+    std::vector<std::pair<double, int>> alternatives;
+
+    for(int direction = 0; direction < 2; direction++){
+        int first_t2 = direction ? tour_.prev(t1) : tour_.next(t1);
+        bool forward = tour_.prev(t1) == first_t2; // t2 precedes t1, so t4 must follow t3
+
+        // The first moves, best look-ahead d(t3,t4) - d(t2,t3) first
+        alternatives.clear();
+        for(int t3 : neighbors_[first_t2]){
+            if(matrix_[t1][first_t2] - matrix_[first_t2][t3] <= IMPROVEMENT_EPSILON)
+                break;
+
+            int t4 = forward ? tour_.next(t3) : tour_.prev(t3);
+            if(t3 == t1 || t4 == first_t2)
+                continue;
+
+            alternatives.push_back({matrix_[t3][t4] - matrix_[first_t2][t3], t3});
+        }
+
+        std::sort(alternatives.begin(), alternatives.end(), std::greater<std::pair<double, int>>());
+        if(alternatives.size() > LK_BREADTH)
+            alternatives.resize(LK_BREADTH);
+
+        for(auto &alternative : alternatives){
+            int t2 = first_t2,
+                t3 = alternative.second,
+                t4,
+                best_depth = 0;
+            double gain = matrix_[t1][t2], // Removed minus added cost, without the closing edge
+                   best_delta = 0,
+                   delta;
+
+            flips_.clear();
+            mark(t1);
+            mark(t2);
+
+            while(flips_.size() < LK_DEPTH){
+                forward = tour_.prev(t1) == t2;
+                t4 = forward ? tour_.next(t3) : tour_.prev(t3);
+
+                move(t2, t1, t3, t4);
+                flips_.push_back({t2, t1, t3, t4});
+                mark(t3);
+                mark(t4);
+
+                gain += matrix_[t3][t4] - matrix_[t2][t3];
+                delta = matrix_[t1][t4] - gain;
+
+                if(delta < best_delta - IMPROVEMENT_EPSILON){
+                    best_delta = delta;
+                    best_depth = flips_.size();
+                }
+
+                // Next step from the best unused candidate that keeps the gain positive
+                double best_value = -INFINITY;
+
+                t2 = t4;
+                t3 = -1;
+                forward = tour_.prev(t1) == t2;
+
+                for(int c : neighbors_[t2]){
+                    if(gain - matrix_[t2][c] <= IMPROVEMENT_EPSILON)
+                        break;
+
+                    int d = forward ? tour_.next(c) : tour_.prev(c);
+                    if(marked_[c] || d == t2)
+                        continue;
+
+                    if(matrix_[c][d] - matrix_[t2][c] > best_value){
+                        best_value = matrix_[c][d] - matrix_[t2][c];
+                        t3 = c;
+                    }
+                }
+
+                if(t3 < 0)
+                    break;
+            }
+
+            undo(best_depth);
+            unmark();
+
+            if(best_depth > 0){
+                for(tFlip &f : flips_){
+                    activate(f.a);
+                    activate(f.b);
+                    activate(f.c);
+                    activate(f.d);
+                }
+
+                return best_delta;
+            }
+        }
+    }
+
+    return 0;
+}
+
+// A function that searches for the first improving move of a segment starting at a to a position next to
+// a candidate list neighbor, in either orientation. Segment: p s1..s2 n; new position: between c and e
+template <class Tour>
+double LinKernighan<Tour>::orOpt(int a){
+    int segment[LK_SEGMENT];
+    double gain, delta;
+
+    auto step = [&](int node, bool backward) -> int{
+        return backward ? tour_.prev(node) : tour_.next(node);
+    };
+
+    auto inSegment = [&](int node, int length) -> bool{
+        return std::find(segment, segment + length, node) != segment + length;
+    };
+
+    for(int direction = 0; direction < 2; direction++){
+        int s1 = a, s2 = a;
+
+        for(int length = 1; length <= LK_SEGMENT; length++){
+            if(length > 1)
+                s2 = step(s2, direction);
+            segment[length-1] = s2;
+
+            int p = step(s1, !direction),
+                n = step(s2, direction);
+
+            gain = matrix_[p][s1] + matrix_[s2][n] - matrix_[p][n];
+            if(gain <= IMPROVEMENT_EPSILON)
+                continue;
+
+            for(int c : neighbors_[s1]){
+                if(matrix_[s1][c] >= gain)
+                    break;
+
+                if(c == p || c == n || inSegment(c, length))
+                    continue;
+
+                // e after c (the segment keeps its direction) or before c (it is reversed)
+                for(int side = 0; side < 2; side++){
+                    int e = step(c, side ? !direction : direction);
+
+                    if(e == p || e == n || inSegment(e, length))
+                        continue;
+
+                    delta =  matrix_[c][s1] + matrix_[s2][e]
+                            -matrix_[c][e] - gain;
+
+                    if(delta < -IMPROVEMENT_EPSILON){
+                        if(!side){
+                            move(p, s1, c, e);
+                            move(p, c, n, s2);
+                            move(c, s2, s1, e);
+                        }
+                        else{
+                            move(s2, n, e, c);
+                            move(p, s1, n, c);
+                        }
+
+                        int changed[] = {p, n, s1, s2, c, e};
+                        for(int node : changed)
+                            activate(node);
+
+                        return delta;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+template class LinKernighan<ArrayTour>;
+template class LinKernighan<TwoLevelTour>;
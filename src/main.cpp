@@ -1,34 +1,69 @@
-#include "include/read_data.h"
+#include "include/instance.h"
 #include "include/mlp.h"
 #include "include/tsp.h"
 #include "include/bb.h"
+#include "include/stream.h"
+#include "include/benchmark.h"
+#include "include/thread_pool.h"
+#include "include/options.h"
+#include "include/batch.h"
+#include "include/server.h"
 
 #include <cstring>
+#include <cstdlib>
 #include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
 
-double **matrix; // Adjacency matrix
-int dimension; // Total vertex number 
+Instance *instance; // The loaded instance
 
 struct args{
-    int instance_index = 0;
+    std::vector<std::string> instances; // Instance files, glob patterns or @lists of them
     char mode = 0;
     bool benchmark = false; 
+    bool stream = false;
+    char *stream_path = NULL;
+    int repetitions = BENCHMARK_REPETITIONS;
+    int jobs = 1;               // Runs (or batch jobs) solved at once, 0 for one per hardware thread
+    const char *optima_path = BENCHMARK_OPTIMA,
+               *report_path = NULL,
+               *baseline_path = NULL,
+               *curves_prefix = NULL,
+               *trace_path = NULL,
+               *batch_path = NULL,      // Manifest of the batch mode
+               *server_path = NULL,     // Unix domain socket of the server mode
+               *client_path = NULL;     // Unix domain socket the client mode connects to
+    int cache = SERVER_CACHE;
+    double regression = REGRESSION_THRESHOLD;
+    tParameters parameters;
 };
 
 args arguments;
 
-Problem* newProblem(){
-    switch(arguments.mode){
+std::mutex output_mutex; // Serializes the output of the concurrent benchmark runs and batch jobs
+
+std::ofstream stream_file;
+std::ostream *stream_output = &std::cout; // Where the incumbents are streamed to
+
+Problem* newProblem(char mode, const Instance &instance, const tParameters &parameters){
+    switch(mode){
             case 'm':
-                return new MLP(&matrix, dimension);
+                return new MLP(instance, parameters);
                 break;
 
             case 't':
-                return new TSP(&matrix, dimension);
+                return new TSP(instance, parameters);
                 break;
 
             case 'b':
-                return new BB(&matrix, dimension);
+                return new BB(instance, parameters);
                 break;
             
             default:
@@ -38,54 +73,466 @@ Problem* newProblem(){
     }
 }
 
-void benchmark(){
-    double cost_mean = 0, 
-           time_mean[7] = {};
+std::map<char, std::vector<Problem*>> idle_solvers; // Solvers of the batch and server modes no job is using, by mode
+std::mutex idle_mutex;
 
-    int64_t *current_time;
+// Returns an idle solver of the mode moved to the instance and the parameters, or a new one if there is none.
+// The solvers are kept for the process lifetime, so the next jobs reuse their buffers
+Problem* takeSolver(char mode, const Instance &instance, const tParameters &parameters){
+    Problem *p = NULL;
 
-    for(int i = 1; i <= 10; i++){
-        Problem *p = newProblem();
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        if(!idle_solvers[mode].empty()){
+            p = idle_solvers[mode].back();
+            idle_solvers[mode].pop_back();
+        }
+    }
 
-        cost_mean += p->getCost();
-        current_time = p->getTimerPointer();
+    if(p == NULL)
+        return newProblem(mode, instance, parameters);
 
-        for(int j = 0; j < 7; j++)
-            time_mean[j] += current_time[j];
+    p->setInstance(instance);
+    p->configure(parameters);
 
-        std::cout << "ITERATION " << i << " COST: " << p->getCost() << "\n";
-        delete p;
+    return p;
+}
+
+void releaseSolver(char mode, Problem *p){
+    std::lock_guard<std::mutex> lock(idle_mutex);
+    idle_solvers[mode].push_back(p);
+}
+
+// Reads an instance into the globals
+void loadInstance(std::string path){
+    instance = new Instance(path);
+    instance->apply(arguments.parameters);
+}
+
+void unloadInstance(){
+    delete instance;
+}
+
+// Solves the loaded instance once with the given solver, recording every incumbent along the way
+tRun solveOnce(Problem *p, tParameters parameters, double optimum){
+    std::function<void(const tIncumbent &)> observer = parameters.observer;
+    timespec start, end;
+    tRun run;
+
+    run.seed = parameters.seed;
+    parameters.observer = [&run, observer](const tIncumbent &incumbent){
+        run.trajectory.push_back({incumbent.time, incumbent.cost});
+
+        if(observer){
+            std::lock_guard<std::mutex> lock(output_mutex);
+            observer(incumbent);
+        }
+    };
+
+    p->configure(parameters);
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    p->solve();
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+
+    int64_t *current_time = p->getTimerPointer();
+
+    run.cpu = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    run.cost = p->getCost();
+    run.wall = current_time[TIMER_TOTAL] / 1000000000.0;
+
+    if(!std::isnan(optimum))
+        run.gap = 100 * (run.cost - optimum) / optimum;
+    else
+        run.gap = p->getLowerBound() > 0 ? p->getGap() : NAN;
+
+    for(int j = 0; j < TIMER_SLOTS; j++){
+        run.phases.push_back(current_time[j] / 1000000000.0);
+        run.labels.push_back(j == TIMER_TOTAL ? "" : p->getTimeLabel(j));
+
+        if(perfEnabled())
+            run.counts.emplace_back(p->getTimeCounts(j), p->getTimeCounts(j) + PERF_EVENTS);
     }
 
-    std::cout << "\n--------======== Averages ========---------\n"
-                << "Average cost: " << cost_mean/10 << "\n"
-                << "Average execution time: " << time_mean[6]/10000000000 << " (s)\n"
-                << "| Construction execution time: " << time_mean[0]/10000000000 << " (s)\n"
-                << "| Swap execution time: " << time_mean[1]/10000000000 << " (s)\n"
-                << "| 2-opt execution time: " << time_mean[2]/10000000000 << " (s)\n"
-                << "| Or-opt execution time: " << time_mean[3]/10000000000 << " (s)\n"
-                << "| Or-opt2 execution time: " << time_mean[4]/10000000000 << " (s)\n"
-                << "| Or-opt3 execution time: " << time_mean[5]/10000000000 << " (s)\n\n";
+    return run;
 }
 
-void argParse(int argc, char** argv){
-    size_t length;
+// Runs every instance the given number of times, run r with the seed (first seed + r), and reports the statistics
+// of each one. The runs of an instance are spread over arguments.jobs threads, each one with its own solver. The
+// solvers are kept for the next runs, and for the next instances, so their buffers are allocated once per dimension.
+// Returns the number of regressions against the baseline
+int benchmark(const std::vector<std::string> &instances){
+    std::map<std::string, double> optima = readOptima(arguments.optima_path);
+    std::vector<tSummary> summaries;
+    std::vector<std::vector<tRun>> instance_runs;
+    unsigned seed = arguments.parameters.seed ? arguments.parameters.seed : rand();
+    std::string mode = arguments.mode == 'm' ? "mlp" : arguments.mode == 'b' ? "bb" : "tsp";
+    int regressions = 0;
+    ThreadPool pool(arguments.jobs);
+    std::vector<Problem*> solvers; // Solvers no run is using
+    std::mutex solvers_mutex;
 
-    if (argc < 3) {
-        std::cerr << "\nERROR: Missing parameters\n"
-                  << " ./solver [Instance] --mode -[optional flags]\n";
+    // The new minimums of concurrent runs would be interleaved
+    if(pool.size() > 1)
+        arguments.parameters.quiet = true;
+
+    for(const std::string &path : instances){
+        std::vector<tRun> runs(arguments.repetitions);
+        double optimum = NAN;
+
+        loadInstance(path);
+
+        for(Problem *p : solvers)
+            p->setInstance(*instance);
+
+        // The known optima are TSP tour lengths
+        if(arguments.mode != 'm' && optima.count(instanceName(path)))
+            optimum = optima[instanceName(path)];
+
+        std::cout << "\n" << path << "\n";
+
+        for(int r = 0; r < arguments.repetitions; r++){
+            pool.submit([&runs, &solvers, &solvers_mutex, r, seed, optimum](){
+                tParameters parameters = arguments.parameters;
+                Problem *p = NULL;
+
+                parameters.seed = seed + r;
+
+                {
+                    std::lock_guard<std::mutex> lock(solvers_mutex);
+                    if(!solvers.empty()){
+                        p = solvers.back();
+                        solvers.pop_back();
+                    }
+                }
+
+                if(p == NULL)
+                    p = newProblem(arguments.mode, *instance, parameters);
+
+                runs[r] = solveOnce(p, parameters, optimum);
+
+                {
+                    std::lock_guard<std::mutex> lock(solvers_mutex);
+                    solvers.push_back(p);
+                }
+
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::cout << "ITERATION " << r+1 << " COST: " << runs[r].cost;
+                if(!std::isnan(runs[r].gap))
+                    std::cout << " GAP: " << runs[r].gap << "%";
+                std::cout << std::endl;
+            });
+        }
+
+        pool.wait();
+
+        summaries.push_back(summarize(path, mode, instance->getDimension(), seed, optimum, runs[0].labels, runs));
+        printSummary(std::cout, summaries.back());
+        instance_runs.push_back(runs);
+
+        unloadInstance();
+    }
+
+    for(Problem *p : solvers)
+        delete p;
+
+    std::cout << "\n";
+
+    if(arguments.report_path != NULL && !writeReport(arguments.report_path, summaries)){
+        std::cerr << "\nERROR: Could not write " << arguments.report_path << "\n";
         exit(1);
     }
 
-    if (argc > 4) {
-        std::cerr << "\nERROR: Too many parameters\n"
-                  << " ./solver [Instance] --mode -[optional flags]\n";
+    if(arguments.curves_prefix != NULL && !writeCurves(arguments.curves_prefix, summaries, instance_runs)){
+        std::cerr << "\nERROR: Could not write the curves to " << arguments.curves_prefix << "-*.csv\n";
+        exit(1);
+    }
+
+    if(arguments.baseline_path != NULL){
+        regressions = compareBaseline(std::cout, arguments.baseline_path, summaries, arguments.regression);
+        std::cout << regressions << " regression(s) beyond " << arguments.regression << "% of " << arguments.baseline_path << "\n";
+    }
+
+    return regressions;
+}
+
+// Solves every job of the manifest and streams each outcome as soon as it is known. The large TSP jobs come first,
+// one at a time on this thread, each one decomposed over as many threads as the pool has workers, so they overlap
+// neither with each other nor with the other jobs. The other ones then share the workers, the largest first so no
+// long job is left running alone at the end. Each worker reuses its solvers from job to job, and the jobs on the
+// same instance file share it. Returns the number of jobs that failed
+int batch(const char *path){
+    std::vector<tJob> jobs = readManifest(path, arguments.parameters);
+    std::vector<int> order(jobs.size());
+    SharedInstances instances(jobs);
+    int failed = 0;
+    ThreadPool pool(arguments.jobs);
+
+    auto run = [&](int k){
+        tJob &job = jobs[k];
+        std::shared_ptr<Instance> instance = instances.acquire(job);
+
+        if(instance == NULL){
+            instances.release(job);
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            writeError(*stream_output, k, job, "Could not read the instance");
+            failed++;
+            return;
+        }
+
+        Problem *p = takeSolver(job.mode, *instance, job.parameters);
+        p->solve();
+        tResult result = p->result();
+        releaseSolver(job.mode, p);
+        instances.release(job);
+
+        std::lock_guard<std::mutex> lock(output_mutex);
+        writeResult(*stream_output, k, job, result);
+    };
+
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&jobs](int a, int b){ return jobs[a].dimension > jobs[b].dimension; });
+
+    for(tJob &job : jobs){
+        // The incumbents of concurrent jobs would be interleaved, only the results are written
+        job.parameters.quiet = true;
+        job.parameters.observer = nullptr;
+
+        if(largeJob(job)){
+            if(job.parameters.decomposition == 0)
+                job.parameters.decomposition = BATCH_DECOMPOSITION;
+            if(job.parameters.threads == 0)
+                job.parameters.threads = pool.size();
+        }
+    }
+
+    for(int k : order)
+        if(largeJob(jobs[k]))
+            run(k);
+
+    for(int k : order)
+        if(!largeJob(jobs[k]))
+            pool.submit([&run, k](){ run(k); });
+
+    pool.wait();
+
+    return failed;
+}
+
+// Answers the request of a connection, a job line as in the batch manifests. The incumbents are streamed back as
+// they are found, followed by the result (or an error), each one as a line of JSON
+void serveRequest(int connection, InstanceCache &cache){
+    std::string buffer, line, error;
+    std::ostringstream out;
+    std::shared_ptr<Instance> instance;
+    bool hit = false;
+    tJob job;
+
+    if(!readLine(connection, buffer, line))
+        return;
+
+    if(!parseJob(line, arguments.parameters, job, error)){
+        sendAll(connection, "{\"event\":\"error\",\"message\":" + jsonString(error) + "}\n");
+        return;
+    }
+
+    if(!job.x.empty())
+        instance = std::make_shared<Instance>(job.x, job.y);
+    else
+        instance = cache.get(job.instance, hit);
+
+    if(instance == NULL){
+        writeError(out, -1, job, "Could not read the instance");
+        sendAll(connection, out.str());
+        return;
+    }
+
+    job.parameters.quiet = true;
+    job.parameters.observer = [connection](const tIncumbent &incumbent){
+        std::ostringstream out;
+
+        writeIncumbent(out, incumbent);
+        sendAll(connection, out.str());
+    };
+
+    Problem *p = takeSolver(job.mode, *instance, job.parameters);
+    p->solve();
+    tResult result = p->result();
+    releaseSolver(job.mode, p);
+
+    writeResult(out, -1, job, result);
+    sendAll(connection, out.str());
+
+    if(!arguments.parameters.quiet){
+        std::lock_guard<std::mutex> lock(output_mutex);
+        std::cout << job.instance << " " << modeName(job.mode) << ": " << result.cost << " in " << result.time << " (s)"
+                  << (hit ? ", cached" : "") << std::endl;
+    }
+}
+
+// Server mode: answers the connections to the Unix domain socket on a persistent pool of arguments.jobs workers, a
+// request per connection, with the last arguments.cache instance files kept parsed. Runs until it is killed
+int serve(const char *path){
+    InstanceCache cache(arguments.cache);
+    ThreadPool pool(arguments.jobs);
+    int server = listenSocket(path),
+        connection;
+
+    if(server < 0){
+        std::cerr << "\nERROR: Could not listen on " << path << "\n";
+        return 1;
+    }
+
+    std::cout << "Listening on " << path << " with " << pool.size() << " worker(s)" << std::endl;
+
+    while(true){
+        if((connection = accept(server, NULL, NULL)) < 0){
+            if(errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+
+        pool.submit([connection, &cache](){
+            serveRequest(connection, cache);
+            close(connection);
+        });
+    }
+
+    std::cerr << "\nERROR: Could not accept on " << path << "\n";
+    close(server);
+
+    return 1;
+}
+
+// Client mode: sends every request line of the standard input to the server, each one on its own connection, and
+// prints the replies. Returns the number of requests without a result
+int client(const char *path){
+    std::string line, buffer, reply;
+    int failed = 0;
+
+    while(std::getline(std::cin, line)){
+        bool solved = false;
+        int connection;
+
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        if((connection = connectSocket(path)) < 0){
+            std::cerr << "\nERROR: Could not connect to " << path << "\n";
+            return failed + 1;
+        }
+
+        buffer.clear();
+        sendAll(connection, line + "\n");
+
+        while(readLine(connection, buffer, reply)){
+            std::cout << reply << std::endl;
+            solved = solved || reply.compare(0, 18, "{\"event\":\"result\"") == 0;
+        }
+
+        close(connection);
+        failed += !solved;
+    }
+
+    return failed;
+}
+
+void argParse(int argc, char** argv){
+    char *value;
+
+    if (argc < 2) {
+        std::cerr << "\nERROR: Missing parameters\n"
+                  << " ./solver [Instance] --mode -[optional flags]\n"
+                  << " ./solver --batch=manifest -[optional flags]\n"
+                  << " ./solver --serve=socket -[optional flags]\n"
+                  << " ./solver --client=socket < requests\n";
         exit(1);
     }
 
     for(int i = 1; i < argc; i++){
-        if(strstr(argv[i], ".tsp") != NULL){
-            arguments.instance_index = i;
+        if(strstr(argv[i], ".tsp") != NULL || argv[i][0] == '@'){
+            arguments.instances.push_back(argv[i]);
+            continue;
+        }
+
+        if(!strcmp(argv[i], "--stream")){
+            arguments.stream = true;
+            continue;
+        }
+
+        if(!strncmp(argv[i], "--stream=", 9)){
+            arguments.stream = true;
+            arguments.stream_path = argv[i] + 9;
+            continue;
+        }
+
+        if(parameterParse(argc, argv, i, arguments.parameters))
+            continue;
+
+        if((value = optionValue(argc, argv, i, "--batch")) != NULL){
+            arguments.batch_path = value;
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--serve")) != NULL){
+            arguments.server_path = value;
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--client")) != NULL){
+            arguments.client_path = value;
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--cache")) != NULL){
+            arguments.cache = atoi(value);
+            continue;
+        }
+
+        if(!strcmp(argv[i], "--perf")){
+            enablePerf();
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--repetitions")) != NULL){
+            arguments.repetitions = atoi(value);
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--optima")) != NULL){
+            arguments.optima_path = value;
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--report")) != NULL){
+            arguments.report_path = value;
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--baseline")) != NULL){
+            arguments.baseline_path = value;
+            continue;
+        }
+
+        if(!strncmp(argv[i], "--trace=", 8)){
+            arguments.trace_path = argv[i] + 8;
+            enableTrace();
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--jobs")) != NULL){
+            arguments.jobs = atoi(value);
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--curves")) != NULL){
+            arguments.curves_prefix = value;
+            continue;
+        }
+
+        if((value = optionValue(argc, argv, i, "--regression")) != NULL){
+            arguments.regression = atof(value);
             continue;
         }
 
@@ -99,36 +546,103 @@ void argParse(int argc, char** argv){
         }
     }
 
-    if(!arguments.instance_index){
+    if(arguments.batch_path != NULL || arguments.server_path != NULL || arguments.client_path != NULL)
+        return;
+
+    arguments.instances = expandInstances(arguments.instances);
+
+    if(arguments.instances.empty()){
         std::cerr << "\nERROR: Invalid instance file\n";
         exit(1);
     }
+
+    if(arguments.instances.size() > 1 && !arguments.benchmark){
+        std::cerr << "\nERROR: Several instances are only solved in benchmark mode (-b)\n";
+        exit(1);
+    }
+}
+
+// Sets up the newline-delimited JSON stream of incumbents
+void streamSetup(){
+    if(arguments.stream_path != NULL){
+        stream_file.open(arguments.stream_path);
+
+        if(!stream_file){
+            std::cerr << "\nERROR: Could not open " << arguments.stream_path << "\n";
+            exit(1);
+        }
+        stream_output = &stream_file;
+    }
+    else
+        arguments.parameters.quiet = true;
+
+    arguments.parameters.observer = [](const tIncumbent &incumbent){
+        writeIncumbent(*stream_output, incumbent);
+    };
+}
+
+// Dumps the trace when the solver exits, whichever way it does
+void traceExit(){
+    if(!writeTrace(arguments.trace_path))
+        std::cerr << "\nERROR: Could not write " << arguments.trace_path << "\n";
 }
 
 int main(int argc, char** argv) {
     argParse(argc, argv);
 
-    readData(argv[arguments.instance_index], &dimension, &matrix);
-    
+    if(arguments.trace_path != NULL)
+        atexit(traceExit);
+
+    if(arguments.stream)
+        streamSetup();
+
     srand(time(NULL));
 
-    std::cout << std::endl;
+    if(arguments.client_path != NULL) // Client of the server mode
+        return client(arguments.client_path) ? 1 : 0;
+
+    if(arguments.server_path != NULL) // Server mode
+        return serve(arguments.server_path);
+
+    if(arguments.batch_path != NULL) // Batch mode
+        return batch(arguments.batch_path) ? 1 : 0;
 
     if(arguments.benchmark) // Benchmark mode
-        benchmark();
+        return benchmark(arguments.instances) ? 2 : 0;
+
+    loadInstance(arguments.instances[0]);
+
+    if(!arguments.parameters.quiet){
+        std::cout << std::endl;
+
+        if(arguments.parameters.asymmetric)
+            std::cout << "Asymmetric matrix\n\n";
+    }
+
+    if(arguments.parameters.quiet){ // Streaming to stdout, only JSON is written
+        Problem* p = newProblem(arguments.mode, *instance, arguments.parameters);
+        p->solve();
+
+        writeIncumbent(std::cout, {&p->getRoute(), p->getCost(), p->getTimerPointer()[TIMER_TOTAL]/1000000000.0, -1}, "final");
+    }
     else{ 
-        Problem* p = newProblem();
+        Problem* p = newProblem(arguments.mode, *instance, arguments.parameters);
+        p->solve();
 
-        if(dimension < 16){
+        if(instance->getDimension() < 16){
             p->printMatrix();
             std::cout << std::endl;
             p->printSolution();
         }
 
-        std::cout << "Total cost: " << p->getCost() << "\n\n";
+        std::cout << "Total cost: " << p->getCost() << "\n";
+        if(p->getLowerBound() > 0)
+            std::cout << "Lower bound: " << p->getLowerBound() << " (gap: " << p->getGap() << "%)\n";
+        std::cout << "\n";
 
         p->printTimes();
+        printPerfThreads(std::cout);
     }
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "include/matrix_allocator.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define MPOL_INTERLEAVE_MODE 3 // MPOL_INTERLEAVE of linux/mempolicy.h
+
+// Size of the block, rounded up to whole huge pages so hugetlbfs can map it
+static size_t blockSize( int rows, int cols ){
+    size_t size = (size_t) rows * cols * sizeof(double);
+
+    return (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+#ifdef __linux__
+// Spreads the pages of the block over the online NUMA nodes, so the threads of every node share its bandwidth.
+// Nothing is done on single node hosts. It must run before the pages are first touched
+static void interleave( void *block, size_t size ){
+    std::ifstream in( "/sys/devices/system/node/online" );
+    std::string ranges;
+    unsigned long mask = 0;
+    int nodes = 0;
+
+    if ( !( in >> ranges ) ) return;
+
+    // A list like "0-1,3"
+    for ( size_t k = 0; k < ranges.size(); ) {
+        size_t end = ranges.find( ',', k );
+        if ( end == std::string::npos ) end = ranges.size();
+
+        std::string range = ranges.substr( k, end - k );
+        size_t dash = range.find( '-' );
+        int first = std::stoi( range.substr( 0, dash ) ),
+            last = dash == std::string::npos ? first : std::stoi( range.substr( dash + 1 ) );
+
+        for ( int node = first; node <= last && node < 8 * (int) sizeof(mask); node++, nodes++ )
+            mask |= 1UL << node;
+
+        k = end + 1;
+    }
+
+    if ( nodes > 1 )
+        syscall( SYS_mbind, block, size, MPOL_INTERLEAVE_MODE, &mask, 8 * sizeof(mask), 0 );
+}
+#endif
+
+double **allocateMatrix( int rows, int cols ){
+    size_t size = blockSize( rows, cols );
+    double **matrix = new double*[rows],
+           *block = NULL;
+
+#ifdef __linux__
+    void *address = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    // Reserved huge pages first, they are only there if the administrator set them up
+    address = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+#endif
+
+    if ( address == MAP_FAILED ) {
+        // Regular pages over an aligned block, which the kernel may back with transparent huge pages
+        char *raw = (char *) mmap( NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+        if ( raw != MAP_FAILED ) {
+            char *aligned = (char *) (( (uintptr_t) raw + HUGE_PAGE_SIZE - 1 ) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+
+            if ( aligned > raw ) munmap( raw, aligned - raw );
+            munmap( aligned + size, raw + HUGE_PAGE_SIZE - aligned );
+
+            address = aligned;
+#ifdef MADV_HUGEPAGE
+            madvise( address, size, MADV_HUGEPAGE );
+#endif
+        }
+    }
+
+    // Out of memory either way
+    if ( address == MAP_FAILED ) throw std::bad_alloc();
+
+    interleave( address, size );
+    block = (double *) address;
+#else
+    block = new double[size / sizeof(double)];
+#endif
+
+    for ( int i = 0; i < rows; i++ )
+        matrix[i] = block + (size_t) i * cols;
+
+    return matrix;
+}
+
+void freeMatrix( double **matrix, int rows, int cols ){
+#ifdef __linux__
+    munmap( matrix[0], blockSize( rows, cols ) );
+#else
+    delete[] matrix[0];
+#endif
+
+    delete[] matrix;
+}
@@ -1,19 +1,446 @@
 #include "include/metaheuristic_problem.h"
 
-MetaheuristicProblem::MetaheuristicProblem(double ***matrix_pointer, int dimension):
-Problem(matrix_pointer, dimension){}
+#include <numeric>
+
+MetaheuristicProblem::MetaheuristicProblem(double ***matrix_pointer, int dimension, const tParameters &params):
+Problem(matrix_pointer, dimension, params), rng_(params.seed ? params.seed : rand()){
+    timer_.setLabel(0, "Construction");
+}
+
+MetaheuristicProblem::MetaheuristicProblem(const Instance &instance, const tParameters &params):
+Problem(instance, params), rng_(params.seed ? params.seed : rand()){
+    timer_.setLabel(0, "Construction");
+}
+
+// Also reseeds the random generator, so the solves that follow are repeatable
+void MetaheuristicProblem::configure(const tParameters &params){
+    if(params.neighbors != params_.neighbors)
+        neighbors_.clear();
+
+    Problem::configure(params);
+    rng_.seed(params_.seed ? params_.seed : rand());
+}
+
+// The candidate lists belong to the previous instance, they are built again on demand
+void MetaheuristicProblem::setInstance(const Instance &instance){
+    Problem::setInstance(instance);
+    neighbors_.clear();
+}
+
+void MetaheuristicProblem::reset(){
+    Problem::reset();
+    timer_.setLabel(0, "Construction");
+    candidate_list_.clear();
+    stats_.assign(stats_.size(), {0, 0, 0});
+}
 
 // Just a function that returns a random number from [1, num]
 int MetaheuristicProblem::random(int num) const{
-    return (rand()%num)+1;
+    return (rng_()%num)+1;
+}
+
+// Fills up the candidate lists with the k nearest nodes of each node, through a k-d tree when there are coordinates
+void MetaheuristicProblem::buildNeighbors(int k){
+    std::vector<int> nodes;
+
+    k = std::min(k, dimension_-1);
+    neighbors_.assign(dimension_, std::vector<int>(k));
+
+    if(params_.x != NULL){
+        nodes.resize(dimension_);
+        std::iota(nodes.begin(), nodes.end(), 0);
+
+        KDTree tree(params_.x, params_.y, nodes);
+        for(int i = 0; i < dimension_; i++)
+            tree.nearest(i, k, neighbors_[i]);
+
+        return;
+    }
+
+    for(int i = 0; i < dimension_; i++){
+        nodes.clear();
+        for(int j = 0; j < dimension_; j++)
+            if(j != i)
+                nodes.push_back(j);
+
+        std::partial_sort(nodes.begin(), nodes.begin() + k, nodes.end(), 
+            [&](int a, int b) -> bool{
+                return matrix_[i][a] < matrix_[i][b];
+            }
+        );
+
+        std::copy(nodes.begin(), nodes.begin() + k, neighbors_[i].begin());
+    }
+}
+
+// Position of the cell (x,y) along the Hilbert curve that fills the HILBERT_SIDE x HILBERT_SIDE grid
+static int64_t hilbertIndex(int x, int y){
+    int64_t index = 0;
+
+    for(int s = HILBERT_SIDE/2; s > 0; s /= 2){
+        int rx = (x & s) > 0,
+            ry = (y & s) > 0;
+
+        index += (int64_t) s * s * ((3 * rx) ^ ry);
+
+        // Rotating the quadrant so the curve inside it has the base orientation
+        if(ry == 0){
+            if(rx == 1){
+                x = HILBERT_SIDE-1 - x;
+                y = HILBERT_SIDE-1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+
+    return index;
+}
+
+// Builds a route with one of the fast constructions, 'h'ilbert curve, 'g'reedy edge or 'n'earest neighbor,
+// starting and ending at the first node. Without coordinates the Hilbert curve falls back to the nearest neighbor
+void MetaheuristicProblem::fastRoute(char construction, int first, std::vector<int> &route){
+    route.clear();
+
+    if(construction == 'h' && params_.x == NULL)
+        construction = 'n';
+
+    if(construction != 'h' && neighbors_.empty())
+        buildNeighbors(params_.neighbors);
+
+    if(construction == 'h')
+        hilbertRoute(route);
+    else if(construction == 'g')
+        greedyRoute(route);
+    else
+        nearestNeighborRoute(first, route);
+
+    std::rotate(route.begin(), std::find(route.begin(), route.end(), first), route.end());
+    route.push_back(first);
+}
+
+// Orders the nodes along a Hilbert curve over their bounding box. One of the 8 symmetries of the square
+// is picked at random, so the restarts get different routes
+void MetaheuristicProblem::hilbertRoute(std::vector<int> &route){
+    const double *x = params_.x, *y = params_.y;
+    std::vector<std::pair<int64_t, int>> keys(dimension_);
+    int symmetry = random(8)-1;
+
+    double min_x = *std::min_element(x, x + dimension_),
+           min_y = *std::min_element(y, y + dimension_),
+           side = std::max(*std::max_element(x, x + dimension_) - min_x, *std::max_element(y, y + dimension_) - min_y),
+           scale = side > 0 ? (HILBERT_SIDE-1) / side : 0;
+
+    for(int i = 0; i < dimension_; i++){
+        int cx = (x[i] - min_x) * scale,
+            cy = (y[i] - min_y) * scale;
+
+        if(symmetry & 1)
+            cx = HILBERT_SIDE-1 - cx;
+        if(symmetry & 2)
+            cy = HILBERT_SIDE-1 - cy;
+        if(symmetry & 4)
+            std::swap(cx, cy);
+
+        keys[i] = {hilbertIndex(cx, cy), i};
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    for(auto &key : keys)
+        route.push_back(key.second);
+}
+
+// Greedy edge over the candidate lists: the edges are added from the cheapest on (up to GREEDY_NOISE of
+// random noise on their costs) while no node gets a third edge and no cycle is closed. The fragments left are then
+// chained from a random one, each end joined to the nearest free end of another fragment
+void MetaheuristicProblem::greedyRoute(std::vector<int> &route){
+    std::vector<tMove<double>> edges;
+    std::vector<int> degree(dimension_, 0),
+                     parent(dimension_),
+                     link(2*dimension_, -1),   // The up to two neighbors of each node
+                     ends;
+    std::vector<char> open(dimension_, false); // Fragment ends not chained yet
+
+    for(int i = 0; i < dimension_; i++)
+        for(int j : neighbors_[i])
+            edges.push_back({std::min(i, j), std::max(i, j),
+                             (matrix_[i][j] + matrix_[j][i]) / 2 * (1 + GREEDY_NOISE * rng_() / rng_.max())});
+
+    std::sort(edges.begin(), edges.end());
+    std::iota(parent.begin(), parent.end(), 0);
+
+    auto find = [&](int a) -> int{
+        while(parent[a] != a)
+            a = parent[a] = parent[parent[a]];
+        return a;
+    };
+
+    auto attach = [&](int a, int b){
+        link[2*a + degree[a]++] = b;
+        link[2*b + degree[b]++] = a;
+    };
+
+    // The last node of the fragment walked from a, coming from the given node (-1 at an end)
+    auto otherEnd = [&](int a, int from) -> int{
+        while(true){
+            int next = link[2*a] != from ? link[2*a] : link[2*a+1];
+            if(next < 0)
+                return a;
+
+            from = a;
+            a = next;
+        }
+    };
+
+    for(tMove<double> &edge : edges)
+        if(degree[edge.i] < 2 && degree[edge.j] < 2 && find(edge.i) != find(edge.j)){
+            attach(edge.i, edge.j);
+            parent[find(edge.i)] = find(edge.j);
+        }
+
+    for(int i = 0; i < dimension_; i++)
+        if(degree[i] < 2){
+            ends.push_back(i);
+            open[i] = true;
+        }
+
+    KDTree tree(params_.x, params_.y, params_.x != NULL ? ends : std::vector<int>());
+
+    auto close = [&](int a){
+        open[a] = false;
+        tree.remove(a);
+    };
+
+    // The nearest open end, by the k-d tree or by a scan of the ends
+    auto nearestEnd = [&](int a) -> int{
+        if(params_.x != NULL)
+            return tree.nearest(a);
+
+        int best = -1;
+        for(int e : ends)
+            if(open[e] && (best < 0 || matrix_[a][e] < matrix_[a][best]))
+                best = e;
+
+        return best;
+    };
+
+    int start = ends[random(ends.size())-1],
+        head = start,
+        from = -1;
+
+    while(true){
+        close(head);
+
+        int tail = otherEnd(head, from),
+            next;
+
+        close(tail);
+
+        if((next = nearestEnd(tail)) < 0){
+            if(tail != start)
+                attach(tail, start);
+            break;
+        }
+
+        attach(tail, next);
+        head = next;
+        from = tail;
+    }
+
+    // Following the cycle
+    for(int k = 0, prev = -1, node = start; k < dimension_; k++){
+        int next = link[2*node] != prev ? link[2*node] : link[2*node+1];
+
+        route.push_back(node);
+        prev = node;
+        node = next;
+    }
+}
+
+// Randomized nearest neighbor: each step moves to one of the NN_CANDIDATES nearest unvisited nodes of the candidate
+// list, picked at random. Once the list has no unvisited node, the nearest one is found by the k-d tree or by a scan
+void MetaheuristicProblem::nearestNeighborRoute(int first, std::vector<int> &route){
+    std::vector<int> nodes(dimension_), 
+                     position(dimension_),
+                     options;
+    std::vector<char> visited(dimension_, false);
+
+    std::iota(nodes.begin(), nodes.end(), 0);
+    std::iota(position.begin(), position.end(), 0);
+
+    KDTree tree(params_.x, params_.y, params_.x != NULL ? nodes : std::vector<int>());
+
+    // nodes keeps the unvisited ones in its first dimension_-route.size() positions
+    auto visit = [&](int node){
+        int last = nodes[dimension_ - route.size() - 1];
+
+        std::swap(nodes[position[node]], nodes[position[last]]);
+        std::swap(position[node], position[last]);
+
+        visited[node] = true;
+        tree.remove(node);
+        route.push_back(node);
+    };
+
+    visit(first);
+
+    for(int current = first; route.size() < dimension_; visit(current)){
+        options.clear();
+        for(int c : neighbors_[current]){
+            if(!visited[c])
+                options.push_back(c);
+            if(options.size() == NN_CANDIDATES)
+                break;
+        }
+
+        if(!options.empty())
+            current = options[random(options.size())-1];
+        else if(params_.x != NULL)
+            current = tree.nearest(current);
+        else{
+            int best = nodes[0];
+            for(int k = 1; k < dimension_ - route.size(); k++)
+                if(matrix_[current][nodes[k]] < matrix_[current][best])
+                    best = nodes[k];
+            current = best;
+        }
+    }
+}
+
+// Chooses the segments [i, i+i_size] and [j, j+j_size], j > i+i_size, swapped by the double bridge, among the inner
+// positions of the route. The classic one draws both lengths from [1, dimension_/10]. The adaptive one uses a single
+// length that starts at PERTURB_BASE and grows with the ILS iterations without improvement, and the local one
+// also starts the second segment at a candidate list neighbor of the end of the first one
+void MetaheuristicProblem::bridgeSegments(const std::vector<int> &route, int stagnation, int &i, int &i_size, int &j, int &j_size){
+    int longest = std::max(1.0, ceil(dimension_/10.0)-1);
+
+    if(params_.perturbation == 'c'){
+        i_size = random(longest);
+        j_size = random(longest);
+    }
+    else
+        i_size = j_size = random(std::min(longest, PERTURB_BASE + stagnation / PERTURB_STEP));
+
+    i = random(dimension_ - (i_size+j_size+2));
+    j = random(dimension_ - (i+i_size+j_size+1)) + (i+i_size);
+
+    if(params_.perturbation != 'l')
+        return;
+
+    if(neighbors_.empty())
+        buildNeighbors(params_.neighbors);
+
+    // The ILS perturbs the same best route until it improves, so the index is only rebuilt once the neighbor moved
+    std::vector<int> &candidates = neighbors_[route[i+i_size]];
+    int c = candidates[random(candidates.size())-1];
+
+    if(positions_.size() != dimension_ || route[positions_[c]] != c){
+        positions_.resize(dimension_);
+        for(int p = 0; p < dimension_; p++)
+            positions_[route[p]] = p;
+    }
+
+    int position = positions_[c];
+
+    // The first node of the route is fixed
+    if(position == 0)
+        return;
+
+    // The segment at the neighbor must fit in the route without overlapping the first one
+    if(position > i+i_size && position + j_size < dimension_)
+        j = position;
+    else if(position + j_size < i){
+        j = i;
+        i = position;
+    }
+}
+
+// Swaps the segments [i, i+i_size] and [j, j+j_size], j > i+i_size, in place. Segments of the same length are
+// exchanged directly, otherwise the positions between them are shifted as well
+void MetaheuristicProblem::swapSegments(std::vector<int> &route, int i, int i_size, int j, int j_size){
+    if(i_size == j_size){
+        std::swap_ranges(route.begin() + i, route.begin() + i + i_size + 1, route.begin() + j);
+        return;
+    }
+
+    // A M B -> (B M A) reversed -> B M A
+    std::reverse(route.begin() + i, route.begin() + j + j_size + 1);
+    std::reverse(route.begin() + i, route.begin() + i + j_size + 1);
+    std::reverse(route.begin() + i + j_size + 1, route.begin() + j + (j_size - i_size));
+    std::reverse(route.begin() + j + (j_size - i_size), route.begin() + j + j_size + 1);
+}
+
+// Picks a position of the neighbor list by roulette on the decayed improvement per nanosecond of each
+// neighborhood. The ones never searched get the best rate, and a uniform pick is kept with ADAPTIVE_EPSILON chance
+int MetaheuristicProblem::adaptiveChoice(const std::vector<int> &neighbor_list){
+    std::vector<double> rates(neighbor_list.size());
+    double best_rate = 0, total = 0, pick;
+
+    if(rng_() < ADAPTIVE_EPSILON * rng_.max())
+        return random(neighbor_list.size())-1;
+
+    for(int k = 0; k < neighbor_list.size(); k++){
+        const tNeighborhoodStats &stats = stats_[neighbor_list[k]];
+
+        rates[k] = stats.calls ? stats.gain / stats.time : -1;
+        best_rate = std::max(best_rate, rates[k]);
+    }
+
+    for(int k = 0; k < neighbor_list.size(); k++){
+        if(rates[k] < 0)
+            rates[k] = best_rate > 0 ? best_rate : 1;
+        total += rates[k];
+    }
+
+    // All of them stopped improving
+    if(total <= 0)
+        return random(neighbor_list.size())-1;
+
+    pick = rng_() / (rng_.max() + 1.0) * total;
+    for(int k = 0; k < neighbor_list.size(); k++){
+        pick -= rates[k];
+        if(pick < 0)
+            return k;
+    }
+
+    return neighbor_list.size()-1;
 }
 
-void MetaheuristicProblem::printTimes(){
-    std::cout << "Total time: " << timer_.getTotalTime() << " (s)\n"
-              << "| Construction execution time: " << timer_.getConstructionTime() << " (s)\n"
-              << "| Swap execution time: " << timer_.getSwapTime() << " (s)\n"
-              << "| 2-opt execution time: " << timer_.getRevertTime() << " (s)\n"
-              << "| Or-opt execution time: " << timer_.getReinsertion1Time() << " (s)\n"
-              << "| Or-opt2 execution time: " << timer_.getReinsertion2Time() << " (s)\n"
-              << "| Or-opt3 execution time: " << timer_.getReinsertion3Time() << " (s)\n\n";
+// Randomized Variable Neighborhood Descent: searches the neighborhoods in random order,
+// dropping the ones that fail and restoring the full list after every improvement
+void MetaheuristicProblem::rvnd(int neighborhoods){
+    std::vector<int> neighbor_list;
+    int i;
+
+    for(i = 0; i < neighborhoods; i++)
+        neighbor_list.push_back(i);
+
+    if(stats_.size() != neighborhoods)
+        stats_.assign(neighborhoods, {0, 0, 0});
+
+    while(!neighbor_list.empty() && !timeUp()){
+        i = params_.rvnd == 'a' ? adaptiveChoice(neighbor_list) : random(neighbor_list.size())-1;
+
+        double cost = getCurrentCost();
+
+        timer_.setTime(neighbor_list[i]+1);
+        bool improved = searchNeighborhood(neighbor_list[i]);
+        int64_t elapsed = timer_.setTime(neighbor_list[i]+1);
+
+        double gain = cost - getCurrentCost();
+        instrumentation_.record(neighbor_list[i]+1, improved, gain, elapsed);
+
+        tNeighborhoodStats &stats = stats_[neighbor_list[i]];
+        stats.gain = ADAPTIVE_DECAY * stats.gain + gain;
+        stats.time = ADAPTIVE_DECAY * stats.time + elapsed;
+        stats.calls++;
+
+        if(!improved)
+            neighbor_list.erase(neighbor_list.begin() + i);
+        else if(neighbor_list.size() != neighborhoods){
+            neighbor_list.clear();
+            for(i = 0; i < neighborhoods; i++)
+                neighbor_list.push_back(i);
+        }
+    }
 }
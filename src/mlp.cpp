@@ -1,19 +1,69 @@
 #include "include/mlp.h"
 
-MLP::MLP(double ***matrix_pointer, int dimension): MetaheuristicProblem(matrix_pointer, dimension){
+MLP::MLP(double ***matrix_pointer, int dimension, const tParameters &params): MetaheuristicProblem(matrix_pointer, dimension, params){
     // Allocating the cost vectors
     s_.cost.resize(dimension_+1, std::vector<tCost>(dimension_+1));
+
+    configure(params_);
+}
+
+MLP::MLP(const Instance &instance, const tParameters &params): MetaheuristicProblem(instance, params){
+    s_.cost.resize(dimension_+1, std::vector<tCost>(dimension_+1));
+
+    configure(params_);
+}
+
+// Builds the neighborhood table of the parameters, the move caches of the previous one are kept for their buffers
+void MLP::configure(const tParameters &params){
+    std::vector<tNeighborhood<MLP>> table = {{&MLP::swap, "Swap"}, {&MLP::revert, "2-opt"}};
+
+    MetaheuristicProblem::configure(params);
+    tOrOptTable<MLP, OROPT_MAX>::fill(table, std::max(1, std::min(params_.oropt_max, OROPT_MAX)));
+
+    for(int i = 0; i < table.size() && i < neighborhoods_.size(); i++)
+        std::swap(table[i].cache, neighborhoods_[i].cache);
+
+    neighborhoods_.swap(table);
+}
+
+// The cost vectors are only allocated again for another dimension
+void MLP::setInstance(const Instance &instance){
+    MetaheuristicProblem::setInstance(instance);
+
+    if(s_.cost.size() != dimension_+1)
+        s_.cost.assign(dimension_+1, std::vector<tCost>(dimension_+1));
+}
+
+void MLP::solve(){
+    reset();
+    s_.route.clear();
+    computeLowerBound();
+
+    // The cached moves were evaluated on an earlier route
+    for(tNeighborhood<MLP> &neighborhood : neighborhoods_)
+        neighborhood.cache.route.clear();
     
     // Defining variables
-    int i, max_iterations = std::min(100, dimension_);
-    std::vector<char> neighbor_list;
+    int i, max_iterations = params_.stagnation ? params_.stagnation : std::min(100, dimension_),
+        restarts = params_.restarts ? params_.restarts : MLP_IMAX;
+    long iteration = 0;
+
+    for(i = 0; i < neighborhoods_.size(); i++)
+        timer_.setLabel(i+1, neighborhoods_[i].label);
+    timer_.setLabel(i+1, "Perturbation");
 
     // GILS
-    for(int i_max = 0; i_max < MLP_IMAX; i_max++){
+    for(int i_max = 0; i_max < restarts; i_max++){
+        if(traceEnabled())
+            traceBegin("Restart");
+
         // Construction
         timer_.setTime(0);
-        construction();
-        timer_.setTime(0);
+        if(params_.construction == 0 || params_.construction == 'c')
+            construction();
+        else
+            fastRoute(params_.construction, 0, s_.route);
+        instrumentation_.record(0, false, 0, timer_.setTime(0));
 
         // Setting up the depot
         s_.cost[0][0] = {0, 0, 0};
@@ -26,85 +76,91 @@ MLP::MLP(double ***matrix_pointer, int dimension): MetaheuristicProblem(matrix_p
 
         fillCost();
 
-        if(i_max == 0)
+        if(i_max == 0){
             final_ = s_;
+            newIncumbent(final_.route, final_.cost[0][final_.LAST].c, iteration);
+        }
         best_ = s_;
 
-        // RVND
-        for(int i_ils = 0; i_ils < max_iterations; i_ils++){
-            neighbor_list = DEFAULT_NEIGHBORLIST;
-            while(!neighbor_list.empty()){
-                i = random(neighbor_list.size())-1;
-                switch(neighbor_list[i]){
-                    case 1:
-                        if(!swap())
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 2:
-                        if(!revert())
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 3:
-                        if(!reinsert(1))
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 4:
-                        if(!reinsert(2))
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 5:
-                        if(!reinsert(3))
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-                }
-            }
+        // ILS
+        for(int i_ils = 0; i_ils < max_iterations; i_ils++, iteration++){
+            rvnd(neighborhoods_.size());
+
             if(s_.cost[0][s_.LAST].c < best_.cost[0][best_.LAST].c){
                 best_ = s_;
                 i_ils = 0;
+
+                if(best_.cost[0][best_.LAST].c < final_.cost[0][final_.LAST].c){
+                    final_ = best_;
+                    newIncumbent(final_.route, final_.cost[0][final_.LAST].c, iteration);
+                }
             }
             else{
                 s_ = best_;
             }
 
-            perturb();
+            if(stop(best_.cost[0][best_.LAST].c))
+                break;
+
+            timer_.setTime(neighborhoods_.size()+1);
+            perturb(i_ils);
+            instrumentation_.record(neighborhoods_.size()+1, false, 0, timer_.setTime(neighborhoods_.size()+1));
         }
+
+        // The restart may end before improving its initial solution
         if(best_.cost[0][best_.LAST].c < final_.cost[0][final_.LAST].c){
             final_ = best_;
-            std::cout << "New minimum: " << final_.cost[0][final_.LAST].c << "\n";
+            newIncumbent(final_.route, final_.cost[0][final_.LAST].c, iteration);
         }
 
         s_.route.clear();
+
+        if(traceEnabled())
+            traceEnd("Restart");
+
+        if(stop(final_.cost[0][final_.LAST].c))
+            break;
     }
 
     timer_.stop();
 }
 
-// Concatenate two subsequences
-inline void MLP::concatenate(tCost &s1, const tCost &s2, int s1_last, int s2_first) const{
-    s1.c += s2.w*(s1.t + matrix_[s_.route[s1_last]][s_.route[s2_first]]) + s2.c;
-    s1.t += matrix_[s_.route[s1_last]][s_.route[s2_first]] + s2.t;
-    s1.w += s2.w;
+// Computes a sorted-edge lower bound. The k-th customer can't be reached before the sum
+// of the k cheapest entering edges, and the first one must be entered from the depot
+void MLP::computeLowerBound(){
+    std::vector<double> entering(dimension_-1, INFINITY);
+    double depot_edge = INFINITY, 
+           depot_bound, 
+           sorted_bound = 0;
+
+    // Cheapest edge entering each customer
+    for(int i = 1; i < dimension_; i++){
+        for(int j = 0; j < dimension_; j++)
+            if(j != i && matrix_[j][i] < entering[i-1])
+                entering[i-1] = matrix_[j][i];
+
+        depot_edge = std::min(depot_edge, matrix_[0][i]);
+    }
+
+    std::sort(entering.begin(), entering.end());
+
+    // The cheapest edge is weighted by all n-1 arrivals, the next one by n-2 and so on
+    depot_bound = (dimension_-1) * depot_edge;
+    for(int k = 0; k < dimension_-1; k++){
+        sorted_bound += (dimension_-1-k) * entering[k];
+
+        if(k < dimension_-2)
+            depot_bound += (dimension_-2-k) * entering[k];
+    }
+
+    lower_bound_ = std::max(sorted_bound, depot_bound);
 }
 
 // Constructs a feasible initial solution
 void MLP::construction(){
     int last = 0,
-        i = 0,
-        interval;
+        interval,
+        rank;
 
     s_.route.push_back(0);
 
@@ -114,17 +170,27 @@ void MLP::construction(){
 
     // Searching for the next node with lowest cost relative to the last node to insert in s_
     while(!candidate_list_.empty()){
-        std::sort(candidate_list_.begin(), candidate_list_.end(), 
+        // Out of time, the remaining nodes are appended as they are
+        if(timeUp()){
+            s_.route.insert(s_.route.end(), candidate_list_.begin(), candidate_list_.end());
+            candidate_list_.clear();
+            break;
+        }
+
+        interval = (int) (random(25)/100.0 * candidate_list_.size());
+        rank = random(interval == 0 ? 1 : interval) - 1;
+
+        // Only the candidate at the picked rank of closeness is needed, not the whole order
+        std::nth_element(candidate_list_.begin(), candidate_list_.begin() + rank, candidate_list_.end(), 
             [&](int j, int k) -> bool{
                 return matrix_[last][j] < matrix_[last][k];
             }
         );
 
-        interval = (int) (random(25)/100.0 * candidate_list_.size());
-        last = random(interval == 0 ? 1 : interval) - 1;
-
-        s_.route.push_back(candidate_list_[last]);
-        candidate_list_.erase(candidate_list_.begin() + last);
+        last = candidate_list_[rank];
+        s_.route.push_back(last);
+        candidate_list_[rank] = candidate_list_.back();
+        candidate_list_.pop_back();
     }
     
     s_.route.push_back(0);
@@ -146,13 +212,15 @@ void MLP::fillCost(){
                              +s_.cost[j][j].w * (s_.cost[i][j-1].t + matrix_[s_.route[j-1]][s_.route[j]]);
 
 
-            s_.cost[j][i].t = s_.cost[i][j].t;
+            // The reversed subsequence, node j followed by [j-1, i] reversed
+            s_.cost[j][i].t = matrix_[s_.route[j]][s_.route[j-1]]
+                             +s_.cost[j-1][i].t;
 
             s_.cost[j][i].w = s_.cost[i][j].w;
             
-            s_.cost[j][i].c = s_.cost[j-1][i].c
-                             +s_.cost[j][j].c
-                             +s_.cost[j][j].w * (s_.cost[j-1][i].t + matrix_[s_.route[j]][s_.route[j-1]]);
+            s_.cost[j][i].c = s_.cost[j][j].c
+                             +s_.cost[j-1][i].c
+                             +s_.cost[j-1][i].w * (s_.cost[j][j].t + matrix_[s_.route[j]][s_.route[j-1]]);
         }
     }
 }
@@ -172,149 +240,151 @@ void MLP::computeCost(int first, int last){
                              +s_.cost[j][j].w * (s_.cost[i][j-1].t + matrix_[s_.route[j-1]][s_.route[j]]);
 
 
-            s_.cost[j][i].t = s_.cost[i][j].t;
+            // The reversed subsequence, node j followed by [j-1, i] reversed
+            s_.cost[j][i].t = matrix_[s_.route[j]][s_.route[j-1]]
+                             +s_.cost[j-1][i].t;
 
             s_.cost[j][i].w = s_.cost[i][j].w;
             
-            s_.cost[j][i].c = s_.cost[j-1][i].c
-                             +s_.cost[j][j].c
-                             +s_.cost[j][j].w * (s_.cost[j-1][i].t + matrix_[s_.route[j]][s_.route[j-1]]);
+            s_.cost[j][i].c = s_.cost[j][j].c
+                             +s_.cost[j-1][i].c
+                             +s_.cost[j-1][i].w * (s_.cost[j][j].t + matrix_[s_.route[j]][s_.route[j-1]]);
         }
     }
 }
 
-// A function that searches for the best nodes i and j to swap 
-bool MLP::swap(){ 
-    tMove<tCost> best_swap = {0, 0, {0, 0, INFINITY}};  //Here we set the cost to INFINITY
-    tCost cost;
-
-    timer_.setTime(1);
-    // Repeating until the swap with lowest cost is found
-    for(int i = 1; i < s_.route.size() - 2; i++){
-        for(int j = i + 2; j < s_.route.size() - 1; j++){
-            cost = s_.cost[0][i-1];
-            concatenate(cost, s_.cost[j][j], i-1, i);
-            concatenate(cost, s_.cost[i+1][j-1], i, i+1);
-            concatenate(cost, s_.cost[i][i], j-1, j);
-            concatenate(cost, s_.cost[j+1][s_.LAST], j, j+1);
-            
-            if(cost.c < best_swap.cost.c){
-                best_swap = {i, j, cost};
-            }
+// Runs the index-th neighborhood of the table
+bool MLP::searchNeighborhood(int index){
+    return (this->*neighborhoods_[index].search)(neighborhoods_[index].cache);
+}
+
+// A function that searches for the best nodes i and j to swap. The cost change of a move only depends on the
+// positions from i-1 to j+1, the ones before and after it shift the latencies by the same amount either way
+bool MLP::swap(tMoveCache &cache){ 
+    int size = s_.route.size();
+
+    tMove<double> best_swap = cachedSearch(cache, s_.route, {-1, 0, 0, 1, true}, 1, size - 2,
+        [&](int i){ return std::make_pair(i + 2, size - 1); },
+        [&](int i, int j) -> double{
+            tCost cost = s_.cost[0][i-1];
+            concatenate(cost, s_.cost[j][j], i-1, j);
+            concatenate(cost, s_.cost[i+1][j-1], j, i+1);
+            concatenate(cost, s_.cost[i][i], j-1, i);
+            concatenate(cost, s_.cost[j+1][s_.LAST], i, j+1);
+
+            return cost.c - s_.cost[0][s_.LAST].c;
         }
-    }
+    );
 
     // Making the swap in the route and inserting the cost in the cost
-    if(best_swap.cost.c < s_.cost[0][s_.LAST].c){
+    if(best_swap.cost < 0){
         std::swap(s_.route[best_swap.i], s_.route[best_swap.j]);
         computeCost(best_swap.i, best_swap.j);
-        timer_.setTime(1);
         return true;
     }
 
-    timer_.setTime(1);
     return false;
 }
 
 // A function that searches for the best range [i,j] to reverse
-bool MLP::revert(){ 
-    tMove<tCost> best_reversion = {0, 0, {0, 0, INFINITY}};
-    tCost cost;
-
-    timer_.setTime(2);
-    for(int i = 1; i < s_.route.size() - 3; i++){
-        for(int j = i + 1; j < s_.route.size() - 1; j++){
-            cost = s_.cost[0][i-1];
-            concatenate(cost, s_.cost[j][i], i-1, i);
-            concatenate(cost, s_.cost[j+1][s_.LAST], j, j+1);
-            
-            if(cost.c < best_reversion.cost.c){
-                best_reversion = {i, j, cost};
-            }
+bool MLP::revert(tMoveCache &cache){ 
+    int size = s_.route.size();
+
+    tMove<double> best_reversion = cachedSearch(cache, s_.route, {-1, 0, 0, 1, true}, 1, size - 3,
+        [&](int i){ return std::make_pair(i + 1, size - 1); },
+        [&](int i, int j) -> double{
+            tCost cost = s_.cost[0][i-1];
+            concatenate(cost, s_.cost[j][i], i-1, j);
+            concatenate(cost, s_.cost[j+1][s_.LAST], i, j+1);
+
+            return cost.c - s_.cost[0][s_.LAST].c;
         }
-    } 
+    );
 
-    if(best_reversion.cost.c < s_.cost[0][s_.LAST].c){
+    if(best_reversion.cost < 0){
         std::reverse(s_.route.begin() + best_reversion.i, s_.route.begin() + best_reversion.j+1);
         computeCost(best_reversion.i, best_reversion.j);
-        timer_.setTime(2);
         return true;
     }
 
-    timer_.setTime(2);
     return false;
 }
 
-// A function that searches for the best j position to reinsert a subsequence [i,num)
-bool MLP::reinsert(int num){ 
-    tMove<tCost> best_reinsertion = {0, 0, {0, 0, INFINITY}};
-    tCost cost;
+// A function that searches for the best j position to reinsert a subsequence [i,Num)
+template <int Num>
+bool MLP::reinsert(tMoveCache &cache){ 
+    int size = s_.route.size();
+
+    tMove<double> best_reinsertion = cachedSearch(cache, s_.route, {-1, Num, -1, Num, true}, 1, size - Num,
+        [&](int i){ return std::make_pair(1, size - Num); },
+        [&](int i, int j) -> double{
+            tCost cost;
 
-    timer_.setTime(2+num);
-    for(int i = 1; i < s_.route.size() - num; i++){
-        for(int j = 1; j < s_.route.size() - num; j++){
             // Checking if the j index is the same as the beginning of the subsequence
-            if(j != i){       
-                if(j > i){
-                    cost = s_.cost[0][i-1];
-                    concatenate(cost, s_.cost[i+num][j], i-1, i+num);
-                    concatenate(cost, s_.cost[i][i+(num-1)], j, i);
-                    concatenate(cost, s_.cost[j+1][s_.LAST], i+(num-1), j+1);
-                }else{
-                    cost = s_.cost[0][j];
-                    concatenate(cost, s_.cost[i][i+(num-1)], j, i);
-                    concatenate(cost, s_.cost[j+1][i-1], i+(num-1), j+1);
-                    concatenate(cost, s_.cost[i+num][s_.LAST], i-1, i+num);
-                }
-                
-                if(cost.c < best_reinsertion.cost.c){
-                    best_reinsertion = {i, j, cost};
-                }
+            if(j == i)
+                return INFINITY;
+
+            // Moving forward, j is the position of the segment once reinserted, as in the rotation below
+            if(j > i){
+                cost = s_.cost[0][i-1];
+                concatenate(cost, s_.cost[i+Num][j+(Num-1)], i-1, i+Num);
+                concatenate(cost, s_.cost[i][i+(Num-1)], j+(Num-1), i);
+                concatenate(cost, s_.cost[j+Num][s_.LAST], i+(Num-1), j+Num);
+            }else{
+                // Moving backward, the segment takes position j and the nodes from j on follow it
+                cost = s_.cost[0][j-1];
+                concatenate(cost, s_.cost[i][i+(Num-1)], j-1, i);
+                concatenate(cost, s_.cost[j][i-1], i+(Num-1), j);
+                concatenate(cost, s_.cost[i+Num][s_.LAST], i-1, i+Num);
             }
+
+            return cost.c - s_.cost[0][s_.LAST].c;
         }
-    }
+    );
     
-    if(best_reinsertion.cost.c < s_.cost[0][s_.LAST].c){    
+    if(best_reinsertion.cost < 0){    
         if (best_reinsertion.i < best_reinsertion.j){
-            std::rotate(s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+num, s_.route.begin() + best_reinsertion.j+num);
-            computeCost(best_reinsertion.i, best_reinsertion.j + num-1);
+            std::rotate(s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+Num, s_.route.begin() + best_reinsertion.j+Num);
+            computeCost(best_reinsertion.i, best_reinsertion.j + Num-1);
         }
         else{
-            std::rotate(s_.route.begin() + best_reinsertion.j, s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+num);
-            computeCost(best_reinsertion.j, best_reinsertion.i + num-1);
+            std::rotate(s_.route.begin() + best_reinsertion.j, s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+Num);
+            computeCost(best_reinsertion.j, best_reinsertion.i + Num-1);
         }
 
-        timer_.setTime(2+num);
         return true;
     }
 
-    timer_.setTime(2+num);
     return false;
 }
 
 // A function that perturbs the solution using the double-bridge method
-void MLP::perturb(){
-    int i_size = random(ceil(dimension_/10.0)-1),    //min = 1 & max = dimension_/10 - 1
-        j_size = random(ceil(dimension_/10.0)-1);
+void MLP::perturb(int stagnation){
+    int i, i_size, j, j_size;
 
-    int i = random(dimension_ - (i_size+j_size+2)),
-        j = random(dimension_ - (i+i_size+j_size+1)) + (i+i_size);
-
-    std::vector<int> sub_route1(s_.route.begin() + i, s_.route.begin() + i + i_size + 1),
-                     sub_route2(s_.route.begin() + j, s_.route.begin() + j + j_size + 1);
-
-    s_.route.erase(s_.route.begin() + j, s_.route.begin() + j + j_size + 1);
-    s_.route.erase(s_.route.begin() + i, s_.route.begin() + i + i_size + 1);
-    s_.route.insert(s_.route.begin() + i, sub_route2.begin(), sub_route2.end());
-    s_.route.insert(s_.route.begin() + j + (j_size - i_size), sub_route1.begin(), sub_route1.end());
+    bridgeSegments(s_.route, stagnation, i, i_size, j, j_size);
+    swapSegments(s_.route, i, i_size, j, j_size);
 
     computeCost(i, j + j_size);
 }
 
+const std::vector<int>& MLP::getRoute(){
+    return final_.route;
+}
+
 double MLP::getCost(){
     return final_.cost[0][final_.LAST].c;
 }
 
+// Returns the cost of the solution being improved
+double MLP::getCurrentCost(){
+    return s_.cost[0][s_.LAST].c;
+}
+
+double MLP::getLowerBound(){
+    return lower_bound_;
+}
+
 double MLP::getRealCost(){
     double sum = 0;
 
@@ -0,0 +1,122 @@
+#include "include/options.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+
+// Returns the value of an option given as "--name=value" or "--name value", or NULL if argv[i] is another option
+char* optionValue(int argc, char** argv, int &i, const char *name){
+    size_t length = strlen(name);
+
+    if(strncmp(argv[i], name, length))
+        return NULL;
+
+    if(argv[i][length] == '=')
+        return argv[i] + length + 1;
+
+    if(argv[i][length] == '\0'){
+        if(i+1 >= argc){
+            std::cerr << "\nERROR: Missing value for " << name << "\n";
+            exit(1);
+        }
+        return argv[++i];
+    }
+
+    return NULL;
+}
+
+bool parameterParse(int argc, char** argv, int &i, tParameters &parameters){
+    char *value;
+
+    if((value = optionValue(argc, argv, i, "--gap")) != NULL){
+        parameters.gap_limit = atof(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--time-limit")) != NULL){
+        parameters.time_limit = atof(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--target")) != NULL){
+        parameters.target = atof(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--stagnation")) != NULL){
+        parameters.stagnation = atoi(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--oropt-max")) != NULL){
+        parameters.oropt_max = atoi(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--neighbors")) != NULL){
+        parameters.neighbors = atoi(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--tour")) != NULL){
+        parameters.tour = value[0];
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--ls")) != NULL){
+        parameters.local_search = value[0];
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--move-cache")) != NULL){
+        parameters.move_cache = atoi(value) != 0;
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--rvnd")) != NULL){
+        parameters.rvnd = value[0];
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--construction")) != NULL){
+        parameters.construction = value[0];
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--assignment")) != NULL){
+        parameters.assignment = value[0];
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--decomposition")) != NULL){
+        parameters.decomposition = atoi(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--perturb")) != NULL){
+        parameters.perturbation = value[0];
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--elite")) != NULL){
+        parameters.elite = atoi(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--threads")) != NULL){
+        parameters.threads = atoi(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--restarts")) != NULL){
+        parameters.restarts = atoi(value);
+        return true;
+    }
+
+    if((value = optionValue(argc, argv, i, "--seed")) != NULL){
+        parameters.seed = strtoul(value, NULL, 10);
+        return true;
+    }
+
+    return false;
+}
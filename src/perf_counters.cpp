@@ -0,0 +1,169 @@
+#include "include/perf_counters.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char *PERF_NAMES[PERF_EVENTS] = {"cycles", "instructions", "cache misses", "dTLB misses", "branch misses", "page faults"};
+
+static std::atomic<bool> enabled(false);
+
+// Totals of every (thread, phase), the threads numbered in the order they first added some
+static std::mutex totals_mutex;
+static std::map<std::thread::id, int> thread_numbers;
+static std::map<std::pair<int, std::string>, std::vector<uint64_t>> totals;
+
+// A structure that holds the perf events of a thread, read together through the first one opened
+struct tPerfGroup{
+    int fds[PERF_EVENTS],
+        position[PERF_EVENTS],  // Position of each event in the group read, -1 if it couldn't be opened
+        size = 0,
+        leader = -1;
+    bool opened = false;
+
+    ~tPerfGroup(){
+#ifdef __linux__
+        for(int k = 0; k < size; k++)
+            close(fds[k]);
+#endif
+    }
+
+    void open(){
+        opened = true;
+        std::fill(position, position + PERF_EVENTS, -1);
+
+#ifdef __linux__
+        const uint32_t types[PERF_EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                             PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE};
+        const uint64_t configs[PERF_EVENTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+                                               PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                                               PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_PAGE_FAULTS};
+
+        for(int event = 0; event < PERF_EVENTS; event++){
+            perf_event_attr attributes;
+
+            memset(&attributes, 0, sizeof(attributes));
+            attributes.size = sizeof(attributes);
+            attributes.type = types[event];
+            attributes.config = configs[event];
+            attributes.read_format = PERF_FORMAT_GROUP;
+            attributes.disabled = leader < 0;
+            attributes.exclude_kernel = 1; // Allowed with the default perf_event_paranoid
+            attributes.exclude_hv = 1;
+
+            // This thread only, on any processor
+            int fd = syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0);
+            if(fd < 0)
+                continue;
+
+            if(leader < 0)
+                leader = fd;
+            position[event] = size;
+            fds[size++] = fd;
+        }
+
+        if(leader >= 0){
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+};
+
+static thread_local tPerfGroup group;
+
+void enablePerf(){
+    enabled = true;
+}
+
+bool perfEnabled(){
+    return enabled;
+}
+
+bool readPerf(uint64_t values[PERF_EVENTS]){
+    if(!group.opened)
+        group.open();
+
+    if(group.leader < 0)
+        return false;
+
+#ifdef __linux__
+    uint64_t buffer[PERF_EVENTS + 1]; // The number of events, then their counts
+
+    if(read(group.leader, buffer, sizeof(buffer)) <= 0)
+        return false;
+
+    for(int event = 0; event < PERF_EVENTS; event++)
+        values[event] = group.position[event] >= 0 ? buffer[1 + group.position[event]] : 0;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool perfAvailable(int event){
+    if(!group.opened)
+        group.open();
+
+    return group.position[event] >= 0;
+}
+
+void addPerfTotals(const std::string &label, const uint64_t values[PERF_EVENTS]){
+    std::lock_guard<std::mutex> lock(totals_mutex);
+    int thread = thread_numbers.emplace(std::this_thread::get_id(), thread_numbers.size()).first->second;
+    std::vector<uint64_t> &total = totals[{thread, label}];
+
+    total.resize(PERF_EVENTS);
+    for(int event = 0; event < PERF_EVENTS; event++)
+        total[event] += values[event];
+}
+
+void printPerf(std::ostream &out, const uint64_t values[PERF_EVENTS]){
+    bool rates = perfAvailable(PERF_INSTRUCTIONS) && values[PERF_INSTRUCTIONS] > 0;
+
+    if(perfAvailable(PERF_CYCLES) && rates)
+        out << " | IPC " << (values[PERF_CYCLES] ? (double)values[PERF_INSTRUCTIONS] / values[PERF_CYCLES] : 0);
+
+    // Misses per thousand instructions when they are counted, otherwise totals
+    for(int event = PERF_CACHE_MISSES; event < PERF_EVENTS; event++){
+        if(!perfAvailable(event))
+            continue;
+
+        if(rates && event != PERF_PAGE_FAULTS)
+            out << " | " << 1000.0 * values[event] / values[PERF_INSTRUCTIONS] << " " << PERF_NAMES[event] << "/kinst";
+        else
+            out << " | " << values[event] << " " << PERF_NAMES[event];
+    }
+}
+
+void printPerfThreads(std::ostream &out){
+    std::lock_guard<std::mutex> lock(totals_mutex);
+
+    if(thread_numbers.size() < 2)
+        return;
+
+    out << "Hardware counters by thread:\n";
+    for(const auto &total : totals){
+        const char *separator = ": ";
+
+        out << "| Thread " << total.first.first << " " << total.first.second;
+        for(int event = 0; event < PERF_EVENTS; event++)
+            if(perfAvailable(event)){
+                out << separator << total.second[event] << " " << PERF_NAMES[event];
+                separator = ", ";
+            }
+        out << "\n";
+    }
+    out << "\n";
+}
@@ -1,9 +1,46 @@
 #include "include/problem.h"
 
-Problem::Problem(double ***matrix_pointer, int dimension){
+Problem::Problem(double ***matrix_pointer, int dimension, const tParameters &params){
     timer_ = Timer();
     matrix_ = *matrix_pointer;
     dimension_ = dimension;
+    params_ = params;
+}
+
+Problem::Problem(const Instance &instance, const tParameters &params){
+    timer_ = Timer();
+    matrix_ = instance.getMatrix();
+    dimension_ = instance.getDimension();
+    params_ = params;
+    instance.apply(params_);
+}
+
+void Problem::configure(const tParameters &params){
+    const double *x = params_.x,
+                 *y = params_.y;
+    bool asymmetric = params_.asymmetric;
+
+    params_ = params;
+    params_.x = x;
+    params_.y = y;
+    params_.asymmetric = asymmetric;
+}
+
+void Problem::setInstance(const Instance &instance){
+    matrix_ = instance.getMatrix();
+    dimension_ = instance.getDimension();
+    instance.apply(params_);
+}
+
+// Clears the times and the counters of the last solve, a solve starts with it
+void Problem::reset(){
+    timer_ = Timer();
+    instrumentation_ = Instrumentation<INSTRUMENTATION != 0>();
+}
+
+// Returns the outcome of the last solve
+tResult Problem::result(){
+    return {getRoute(), getCost(), getLowerBound(), timer_.getTotalTime()};
 }
 
 void Problem::printMatrix(){
@@ -16,10 +53,88 @@ void Problem::printMatrix(){
     }
 }
 
+// Returns a lower bound on the optimal cost, or 0 if the solver doesn't compute one
+double Problem::getLowerBound(){
+    return 0;
+}
+
+// Returns the optimality gap (%) between the final cost and the lower bound
+double Problem::getGap(){
+    double cost = getCost(),
+           lower_bound = getLowerBound();
+
+    if(lower_bound <= 0 || cost <= 0)
+        return 100;
+
+    return 100 * (cost - lower_bound) / cost;
+}
+
+// Reports a new best solution to the user and to the observer
+void Problem::newIncumbent(const std::vector<int> &route, double cost, long iteration){
+    double lower_bound = getLowerBound();
+
+    if(!params_.quiet){
+        std::cout << "New minimum: " << cost;
+        if(lower_bound > 0)
+            std::cout << " (gap: " << 100 * (cost - lower_bound) / cost << "%)";
+        std::cout << "\n";
+    }
+
+    if(params_.observer)
+        params_.observer({&route, cost, timer_.getElapsedTime(), iteration});
+}
+
+// Checks if the wall-clock budget is exhausted
+bool Problem::timeUp(){
+    return params_.time_limit > 0 && timer_.getElapsedTime() >= params_.time_limit;
+}
+
+// Checks if the search should stop with an incumbent of the given cost
+bool Problem::stop(double cost){
+    if(timeUp())
+        return true;
+
+    if(params_.target > 0 && cost <= params_.target)
+        return true;
+
+    double lower_bound = getLowerBound();
+
+    return params_.gap_limit > 0 && lower_bound > 0 && 100 * (cost - lower_bound) / cost <= params_.gap_limit;
+}
+
 int64_t* Problem::getTimerPointer(){
     return timer_.getPointer();
 }
 
+// Returns the counters of every timer slot, all zero if the solver was built without instrumentation
+const tInstrumentation& Problem::getInstrumentation(){
+    return instrumentation_.get();
+}
+
+void Problem::printTimes(){
+    std::cout << "Total time: " << timer_.getTotalTime() << " (s)\n";
+
+    for(int i = 0; i < TIMER_TOTAL; i++)
+        if(!timer_.getLabel(i).empty()){
+            std::cout << "| " << timer_.getLabel(i) << " execution time: " << timer_.getTime(i) << " (s)";
+            printCounters(std::cout, getInstrumentation().slots[i], timer_.getTime(i));
+            if(perfEnabled())
+                printPerf(std::cout, timer_.getCounts(i));
+            std::cout << "\n";
+        }
+
+    std::cout << "\n";
+}
+
+const std::string& Problem::getTimeLabel(int part){
+    return timer_.getLabel(part);
+}
+
+// Returns the perf event counts of a timer slot, all zero unless they were enabled
+const uint64_t* Problem::getTimeCounts(int part){
+    return timer_.getCounts(part);
+}
+
 void Problem::printRoute(std::vector<int> &route){
     for(int i = 0; i < route.size(); i++)
         printf("%d%s", route[i]+1, i+1 == route.size()?"\n":", ");
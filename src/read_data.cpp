@@ -2,6 +2,7 @@
 #include <cstdlib>
 #include <fstream>
 #include <cmath>
+#include "include/matrix_allocator.h"
 
 using namespace std;
 
@@ -10,7 +11,8 @@ double CalcDistAtt ( double *X, double *Y, int I, int J );
 void CalcLatLong ( double *X, double *Y, int n, double *latit, double* longit );
 double CalcDistGeo ( double *latit, double *longit, int I, int J );
 
-void readData( char *instance, int* dimension, double ***matrix ){
+// The coordinates are only returned for the planar weight types (EUC_2D, CEIL_2D and ATT), NULL otherwise
+void readData( char *instance, int* dimension, double ***matrix, double **coord_x, double **coord_y ){
     int N;
     string arquivo, ewt;
 
@@ -40,11 +42,7 @@ void readData( char *instance, int* dimension, double ***matrix ){
     double *y = new double [N];
 
     // Alocar matriz 2D
-    double **dist = new double*[N];
-
-    for ( int i = 0; i < N; i++ ) {
-        dist [i] = new double [N];
-    }
+    double **dist = allocateMatrix( N, N );
 
     if ( ewt == "EXPLICIT" ) {
 
@@ -290,6 +288,9 @@ void readData( char *instance, int* dimension, double ***matrix ){
             }
         }
 
+        delete [] latitude;
+        delete [] longitude;
+
     }
 
     else if ( ewt == "ATT" ) {
@@ -309,6 +310,9 @@ void readData( char *instance, int* dimension, double ***matrix ){
             y[i]=tempY[i];
         }
 
+        delete [] tempX;
+        delete [] tempY;
+
         // Calcular Matriz Distancia (Pesudo-Euclidiana)
         for ( int i = 0; i < N; i++ ) {
             for ( int j = 0; j < N; j++ ) {
@@ -327,6 +331,15 @@ void readData( char *instance, int* dimension, double ***matrix ){
     else if ( ewt == "SPECIAL" ) {
         cout << "SPECIAL - Not supported!" << endl; }
 
+    bool planar = ewt == "EUC_2D" || ewt == "CEIL_2D" || ewt == "ATT";
+
+    // The caller owns the coordinates it gets back, the others are freed here
+    if ( coord_x != NULL ) *coord_x = planar ? x : NULL;
+    if ( coord_y != NULL ) *coord_y = planar ? y : NULL;
+
+    if ( coord_x == NULL || !planar ) delete [] x;
+    if ( coord_y == NULL || !planar ) delete [] y;
+
     *dimension = N;
     *matrix = dist;
 }
@@ -382,3 +395,32 @@ double CalcDistGeo ( double *latit, double *longit, int I, int J )
     return
     (int) ( RRR * acos( 0.5*((1.0+q1)*q2 - (1.0-q1)*q3) ) + 1.0);
 }
+
+// Checks whether any pair of opposite arcs has different costs
+bool isAsymmetric( double **matrix, int dimension ){
+    for ( int i = 0; i < dimension; i++ ) {
+        for ( int j = i+1; j < dimension; j++ ) {
+            if ( matrix[i][j] != matrix[j][i] ) return true;
+        }
+    }
+
+    return false;
+}
+
+// Reads the DIMENSION of an instance from its header alone, -1 if the file can't be read or has none
+int readDimension( const char *instance ){
+    int N = -1;
+    string arquivo;
+
+    ifstream in( instance, ios::in );
+
+    while ( in >> arquivo ) {
+        if ( arquivo.compare("DIMENSION:") == 0 || arquivo.compare("DIMENSION") == 0 ) {
+            if ( arquivo.compare("DIMENSION") == 0 )  in >> arquivo;
+            in >> N;
+            break;
+        }
+    }
+
+    return in ? N : -1;
+}
@@ -0,0 +1,126 @@
+#include "include/server.h"
+#include "include/read_data.h"
+
+#include <cstring>
+#include <fstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+InstanceCache::InstanceCache(int capacity): capacity_(std::max(1, capacity)){}
+
+std::shared_ptr<Instance> InstanceCache::get(const std::string &path, bool &hit){
+    std::shared_ptr<Instance> instance;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(path);
+
+        if((hit = found != index_.end())){
+            entries_.splice(entries_.begin(), entries_, found->second);
+            return found->second->second;
+        }
+    }
+
+    // Read without the lock, the other requests go on meanwhile. Two misses of the same file both read it
+    if(readDimension(path.c_str()) <= 0 || !std::ifstream(path))
+        return NULL;
+
+    instance = std::make_shared<Instance>(path);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(index_.count(path))
+        return instance;
+
+    entries_.emplace_front(path, instance);
+    index_[path] = entries_.begin();
+
+    if(entries_.size() > capacity_){
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+
+    return instance;
+}
+
+// Fills the address of the socket at the path, returns false if the path is too long
+static bool socketAddress(const char *path, sockaddr_un &address){
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if(strlen(path) >= sizeof(address.sun_path))
+        return false;
+
+    strcpy(address.sun_path, path);
+    return true;
+}
+
+int listenSocket(const char *path){
+    sockaddr_un address;
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(server < 0 || !socketAddress(path, address)){
+        if(server >= 0)
+            close(server);
+        return -1;
+    }
+
+    unlink(path);
+
+    if(bind(server, (sockaddr *) &address, sizeof(address)) < 0 || listen(server, SERVER_BACKLOG) < 0){
+        close(server);
+        return -1;
+    }
+
+    return server;
+}
+
+int connectSocket(const char *path){
+    sockaddr_un address;
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(client < 0 || !socketAddress(path, address) || connect(client, (sockaddr *) &address, sizeof(address)) < 0){
+        if(client >= 0)
+            close(client);
+        return -1;
+    }
+
+    return client;
+}
+
+bool sendAll(int socket, const std::string &data){
+    size_t sent = 0;
+
+    while(sent < data.size()){
+        ssize_t n = send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+        if(n <= 0)
+            return false;
+        sent += n;
+    }
+
+    return true;
+}
+
+bool readLine(int socket, std::string &buffer, std::string &line){
+    char chunk[SERVER_BUFFER];
+    size_t searched = 0,
+           end;
+    ssize_t n;
+
+    while((end = buffer.find('\n', searched)) == std::string::npos){
+        searched = buffer.size();
+
+        if((n = recv(socket, chunk, sizeof(chunk), 0)) <= 0)
+            return false;
+        buffer.append(chunk, n);
+    }
+
+    line = buffer.substr(0, end);
+    buffer.erase(0, end+1);
+
+    if(!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+    return true;
+}
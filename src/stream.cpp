@@ -0,0 +1,42 @@
+#include "include/stream.h"
+
+#include <cstdio>
+
+// Writes an incumbent as a single line of JSON (nodes are numbered from 1, as in the instance file)
+void writeIncumbent(std::ostream &out, const tIncumbent &incumbent, const char *event){
+    std::streamsize precision = out.precision(15);
+
+    out << "{\"event\":\"" << event << "\""
+        << ",\"cost\":" << incumbent.cost
+        << ",\"time\":" << incumbent.time;
+
+    if(incumbent.iteration >= 0)
+        out << ",\"iteration\":" << incumbent.iteration;
+
+    out << ",\"route\":[";
+    for(int i = 0; i < incumbent.route->size(); i++)
+        out << (i ? "," : "") << (*incumbent.route)[i]+1;
+    out << "]}" << std::endl;
+
+    out.precision(precision);
+}
+
+std::string jsonString(const std::string &text){
+    std::string quoted = "\"";
+
+    for(char c : text){
+        if(c == '"' || c == '\\'){
+            quoted += '\\';
+            quoted += c;
+        }
+        else if((unsigned char)c < 0x20){
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        }
+        else
+            quoted += c;
+    }
+
+    return quoted + "\"";
+}
@@ -0,0 +1,65 @@
+#include "include/thread_pool.h"
+
+#include <algorithm>
+
+// Starts the given number of workers, one per hardware thread if 0
+ThreadPool::ThreadPool(int threads): pending_(0), stopping_(false){
+    if(threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for(int i = 0; i < threads; i++)
+        workers_.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+
+    for(std::thread &worker : workers_)
+        worker.join();
+}
+
+void ThreadPool::work(){
+    while(true){
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_.wait(lock, [this](){ return stopping_ || !tasks_.empty(); });
+
+            if(tasks_.empty())
+                return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(--pending_ == 0)
+            done_.notify_all();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        pending_++;
+    }
+    work_.notify_one();
+}
+
+// Blocks until every submitted task has finished
+void ThreadPool::wait(){
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this](){ return pending_ == 0; });
+}
+
+int ThreadPool::size() const{
+    return workers_.size();
+}
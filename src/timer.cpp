@@ -1,54 +1,102 @@
 #include "include/timer.h"
+#include "include/trace.h"
 
 Timer::Timer(){
-    totalT0 = high_resolution_clock::now();
-    hasRun = false;
+    tickLength();
+    totalStart = readTicks();
 }
 
-void Timer::setTime(char part){
-    if(!hasRun)
-        t0 = high_resolution_clock::now();
+// Returns the nanoseconds per tick of readTicks, measured once per process
+double Timer::tickLength(){
+    static const double length = [](){
+        steady_clock::time_point t0 = steady_clock::now(), t1;
+        int64_t ticks = readTicks();
+
+        while((t1 = steady_clock::now()) - t0 < nanoseconds(TICK_CALIBRATION));
+
+        ticks = readTicks() - ticks;
+        return ticks > 0 ? (double)duration_cast<nanoseconds>(t1 - t0).count() / ticks : 1.0;
+    }();
+
+    return length;
+}
+
+// Starts the slot if it isn't running, otherwise stops it and returns the nanoseconds since it started.
+// Each slot runs on its own, so the slots may be nested
+int64_t Timer::setTime(int part){
+    uint64_t values[PERF_EVENTS];
+    int64_t now,
+            elapsed = 0;
+
+    if(traceEnabled() && !labels[part].empty()){
+        if(!running[part])
+            traceBegin(labels[part]);
+        else
+            traceEnd(labels[part]);
+    }
+
+    // The perf events are read inside the interval of the clock, so the clock doesn't count their read
+    if(!running[part]){
+        starts[part] = readTicks();
+
+        if(perfEnabled())
+            readPerf(startCounts[part]);
+    }
     else{
-        t1 = high_resolution_clock::now();
-        durations[part] += duration_cast<nanoseconds>(t1 - t0).count();
+        if(perfEnabled() && readPerf(values))
+            for(int event = 0; event < PERF_EVENTS; event++)
+                counts[part][event] += values[event] - startCounts[part][event];
+
+        now = readTicks();
+        elapsed = (now - starts[part]) * tickLength();
+        durations[part] += elapsed;
     }
 
-    hasRun = !hasRun;
+    running[part] = !running[part];
+
+    return elapsed;
 }
 
+// Names a slot so it is reported by printTimes
+void Timer::setLabel(int part, const std::string &label){
+    labels[part] = label;
+}
+
+// Stops the total time and adds the perf event counts of the slots to the totals of the thread
 void Timer::stop(){
-    totalT1 = high_resolution_clock::now();
-    durations[6] = duration_cast<nanoseconds>(totalT1 - totalT0).count();
+    durations[TIMER_TOTAL] = (readTicks() - totalStart) * tickLength();
+
+    if(perfEnabled())
+        for(int part = 0; part < TIMER_TOTAL; part++)
+            if(!labels[part].empty())
+                addPerfTotals(labels[part], counts[part]);
 }
 
 int64_t* Timer::getPointer(){
     return durations;
 }
 
-double Timer::getConstructionTime(){
-    return (double)durations[0]/1000000000;
+const uint64_t* Timer::getCounts(int part){
+    return counts[part];
 }
 
-double Timer::getSwapTime(){
-    return (double)durations[1]/1000000000;
+const std::string& Timer::getLabel(int part){
+    return labels[part];
 }
 
-double Timer::getRevertTime(){
-    return (double)durations[2]/1000000000;
+double Timer::getTime(int part){
+    return (double)durations[part]/1000000000;
 }
 
-double Timer::getReinsertion1Time(){
-    return (double)durations[3]/1000000000;
+double Timer::getConstructionTime(){
+    return getTime(0);
 }
 
-double Timer::getReinsertion2Time(){
-    return (double)durations[4]/1000000000;
+double Timer::getTotalTime(){
+    return getTime(TIMER_TOTAL);
 }
 
-double Timer::getReinsertion3Time(){
-    return (double)durations[5]/1000000000;
+// Returns the seconds elapsed since the timer was created
+double Timer::getElapsedTime(){
+    return (readTicks() - totalStart) * tickLength() / 1000000000;
 }
-
-double Timer::getTotalTime(){
-    return (double)durations[6]/1000000000;
-}
\ No newline at end of file
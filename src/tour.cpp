@@ -0,0 +1,270 @@
+#include "include/tour.h"
+
+#include <cmath>
+#include <algorithm>
+
+//-----===== ArrayTour =====-----
+
+ArrayTour::ArrayTour(int dimension): order_(dimension), position_(dimension), dimension_(dimension){}
+
+// Builds the tour from a route (a trailing copy of the first node is ignored)
+void ArrayTour::build(const std::vector<int> &route){
+    for(int i = 0; i < dimension_; i++){
+        order_[i] = route[i];
+        position_[route[i]] = i;
+    }
+}
+
+// Writes the tour as a route that starts and ends at the start node
+void ArrayTour::getRoute(std::vector<int> &route, int start) const{
+    route.resize(dimension_+1);
+
+    for(int i = 0, a = start; i <= dimension_; i++, a = next(a))
+        route[i] = a;
+}
+
+bool ArrayTour::between(int a, int b, int c) const{
+    int pa = position_[a], pb = position_[b], pc = position_[c];
+
+    if(pa <= pc)
+        return pa <= pb && pb <= pc;
+
+    return pb >= pa || pb <= pc;
+}
+
+// Reverses the positions [first, last], wrapping around the end of the array
+void ArrayTour::reverse(int first, int last){
+    int length = (last - first + dimension_) % dimension_ + 1;
+
+    for(int k = 0; k < length/2; k++){
+        std::swap(order_[first], order_[last]);
+        position_[order_[first]] = first;
+        position_[order_[last]] = last;
+
+        first = first+1 == dimension_ ? 0 : first+1;
+        last = last == 0 ? dimension_-1 : last-1;
+    }
+}
+
+// Reverses the path b..c, or the path d..a if it is shorter
+void ArrayTour::flip(int a, int b, int c, int d){
+    int length = (position_[c] - position_[b] + dimension_) % dimension_ + 1;
+
+    if(2*length <= dimension_)
+        reverse(position_[b], position_[c]);
+    else
+        reverse(position_[d], position_[a]);
+}
+
+//-----===== TwoLevelTour =====-----
+
+TwoLevelTour::TwoLevelTour(int dimension): parent_(dimension), seq_(dimension), next_(dimension), prev_(dimension), dimension_(dimension){
+    group_size_ = std::max(8, (int)sqrt(dimension));
+}
+
+// Builds the tour from a route, splitting it into segments of group_size_ nodes
+void TwoLevelTour::build(const std::vector<int> &route){
+    int count = (dimension_ + group_size_ - 1) / group_size_;
+
+    segments_.resize(count);
+
+    for(int s = 0; s < count; s++){
+        int first = s * group_size_,
+            last = std::min(dimension_, first + group_size_) - 1;
+
+        segments_[s] = {false, route[first], route[last], (s+1) % count, (s+count-1) % count, s};
+
+        for(int i = first; i <= last; i++){
+            parent_[route[i]] = s;
+            seq_[route[i]] = i - first;
+            next_[route[i]] = i < last ? route[i+1] : -1;
+            prev_[route[i]] = i > first ? route[i-1] : -1;
+        }
+    }
+
+    head_ = 0;
+}
+
+// Writes the tour as a route that starts and ends at the start node
+void TwoLevelTour::getRoute(std::vector<int> &route, int start) const{
+    route.resize(dimension_+1);
+
+    for(int i = 0, a = start; i <= dimension_; i++, a = next(a))
+        route[i] = a;
+}
+
+bool TwoLevelTour::between(int a, int b, int c) const{
+    long pa = position(a), pb = position(b), pc = position(c);
+
+    if(pa <= pc)
+        return pa <= pb && pb <= pc;
+
+    return pb >= pa || pb <= pc;
+}
+
+// Numbers the segments in tour order, starting from head_
+void TwoLevelTour::rank(){
+    int s = head_, r = 0;
+
+    do{
+        segments_[s].rank = r++;
+        s = segments_[s].next;
+    }while(s != head_);
+}
+
+// Makes the node the first (before) or the last (!before) of its segment in tour order.
+// The smaller side of the segment is moved to a new segment, keeping its sequence numbers
+void TwoLevelTour::split(int node, bool before){
+    int s = parent_[node];
+
+    if(before ? head(s) == node : tail(s) == node)
+        return;
+
+    // The cut falls between x and y in tour order, or between u and v in the segment's own direction
+    int x = before ? prev(node) : node,
+        y = before ? node : next(node);
+    bool reversed = segments_[s].reversed;
+    int u = reversed ? y : x,
+        v = reversed ? x : y;
+
+    bool move_second = seq_[segments_[s].last] - seq_[v] <= seq_[u] - seq_[segments_[s].first];
+    int from = move_second ? v : segments_[s].first,
+        to = move_second ? segments_[s].last : u,
+        t = segments_.size();
+
+    segments_.push_back({reversed, from, to, -1, -1, 0});
+
+    for(int a = from; ; a = next_[a]){
+        parent_[a] = t;
+        if(a == to)
+            break;
+    }
+
+    next_[u] = -1;
+    prev_[v] = -1;
+
+    if(move_second)
+        segments_[s].last = u;
+    else
+        segments_[s].first = v;
+
+    // Linking the new segment after or before s in tour order
+    if(move_second != reversed){
+        segments_[t].prev = s;
+        segments_[t].next = segments_[s].next;
+        segments_[segments_[s].next].prev = t;
+        segments_[s].next = t;
+    }
+    else{
+        segments_[t].next = s;
+        segments_[t].prev = segments_[s].prev;
+        segments_[segments_[s].prev].next = t;
+        segments_[s].prev = t;
+    }
+
+    rank();
+}
+
+// Reverses the path b..c, which lies inside a single segment
+void TwoLevelTour::reverseInside(int b, int c){
+    tSegment &s = segments_[parent_[b]];
+    int x = s.reversed ? c : b,
+        y = s.reversed ? b : c;
+    int before = x == s.first ? -1 : prev_[x],
+        after = y == s.last ? -1 : next_[y],
+        base = seq_[x];
+
+    buffer_.clear();
+    for(int a = x; ; a = next_[a]){
+        buffer_.push_back(a);
+        if(a == y)
+            break;
+    }
+
+    int k = buffer_.size();
+    for(int i = 0; i < k; i++){
+        int a = buffer_[k-1-i];
+
+        seq_[a] = base + i;
+        next_[a] = i+1 < k ? buffer_[k-2-i] : after;
+        prev_[a] = i > 0 ? buffer_[k-i] : before;
+    }
+
+    if(before == -1)
+        s.first = buffer_[k-1];
+    else
+        next_[before] = buffer_[k-1];
+
+    if(after == -1)
+        s.last = buffer_[0];
+    else
+        prev_[after] = buffer_[0];
+}
+
+// Reverses the run of whole segments first..last (tour order)
+void TwoLevelTour::reverseSegments(int first, int last){
+    int before = segments_[first].prev,
+        after = segments_[last].next;
+
+    buffer_.clear();
+    for(int s = first; ; s = segments_[s].next){
+        buffer_.push_back(s);
+        segments_[s].reversed = !segments_[s].reversed;
+        if(s == last)
+            break;
+    }
+
+    int k = buffer_.size();
+
+    // The whole tour is reversed
+    if(after == first){
+        for(int i = 0; i < k; i++)
+            std::swap(segments_[buffer_[i]].next, segments_[buffer_[i]].prev);
+    }
+    else{
+        for(int i = 0; i < k; i++){
+            tSegment &s = segments_[buffer_[k-1-i]];
+
+            s.prev = i == 0 ? before : buffer_[k-i];
+            s.next = i == k-1 ? after : buffer_[k-2-i];
+        }
+
+        segments_[before].next = buffer_[k-1];
+        segments_[after].prev = buffer_[0];
+    }
+
+    rank();
+}
+
+// Reverses the path b..c, or d..a when it is shorter
+void TwoLevelTour::flip(int a, int b, int c, int d){
+    int count = segments_.size();
+
+    // Splits keep adding segments, so the lists are rebuilt once there are too many
+    if(count > 2 * ((dimension_ + group_size_ - 1) / group_size_)){
+        std::vector<int> route;
+        getRoute(route, a);
+        build(route);
+        count = segments_.size();
+    }
+
+    if(parent_[b] == parent_[c] && position(b) <= position(c)){
+        reverseInside(b, c);
+        return;
+    }
+
+    if(parent_[d] == parent_[a] && position(d) <= position(a)){
+        reverseInside(d, a);
+        return;
+    }
+
+    // Reversing the side that spans less segments
+    if(2 * ((segments_[parent_[c]].rank - segments_[parent_[b]].rank + count) % count) > count){
+        std::swap(b, d);
+        std::swap(a, c);
+    }
+
+    split(b, true);
+    split(c, false);
+    reverseSegments(parent_[b], parent_[c]);
+}
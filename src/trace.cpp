@@ -0,0 +1,132 @@
+#include "include/trace.h"
+#include "include/timer.h"
+
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// A structure that holds the events of a thread. Only its thread writes to it
+struct tTraceBuffer{
+    int thread;
+    std::deque<tTraceEvent> events;
+    std::unordered_map<std::string, const char*> names; // Interned names already looked up by the thread
+    int dropped = 0; // Spans begun while the buffer was full and not ended yet
+};
+
+static std::atomic<bool> enabled(false);
+
+// The buffers outlive their threads, so the workers of a pool can be traced after they exit
+static std::mutex registry_mutex;
+static std::vector<std::unique_ptr<tTraceBuffer>> buffers;
+static std::set<std::string> interned;
+
+static thread_local tTraceBuffer *buffer = NULL;
+
+// A function that registers the buffer of the calling thread on its first event
+static tTraceBuffer& threadBuffer(){
+    if(buffer == NULL){
+        std::lock_guard<std::mutex> lock(registry_mutex);
+
+        buffers.emplace_back(new tTraceBuffer());
+        buffer = buffers.back().get();
+        buffer->thread = buffers.size() - 1;
+    }
+
+    return *buffer;
+}
+
+// A function that returns the interned copy of the name, the lock is only taken the first time a thread sees it
+static const char* intern(tTraceBuffer &buffer, const std::string &name){
+    std::unordered_map<std::string, const char*>::iterator found = buffer.names.find(name);
+
+    if(found != buffer.names.end())
+        return found->second;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const char *copy = interned.insert(name).first->c_str();
+
+    buffer.names[name] = copy;
+    return copy;
+}
+
+void enableTrace(){
+    enabled = true;
+}
+
+bool traceEnabled(){
+    return enabled;
+}
+
+void traceBegin(const std::string &name){
+    tTraceBuffer &buffer = threadBuffer();
+
+    if(buffer.dropped || buffer.events.size() >= TRACE_MAX_EVENTS){
+        buffer.dropped++;
+        return;
+    }
+
+    buffer.events.push_back({intern(buffer, name), readTicks(), 'B'});
+}
+
+void traceEnd(const std::string &name){
+    tTraceBuffer &buffer = threadBuffer();
+
+    // Its begin was dropped
+    if(buffer.dropped){
+        buffer.dropped--;
+        return;
+    }
+
+    buffer.events.push_back({intern(buffer, name), readTicks(), 'E'});
+}
+
+// A function that writes a name as a JSON string
+static void writeName(std::ostream &out, const char *name){
+    out << "\"";
+    for(; *name; name++){
+        if(*name == '"' || *name == '\\')
+            out << "\\";
+        out << *name;
+    }
+    out << "\"";
+}
+
+bool writeTrace(const char *path){
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::ofstream out(path);
+    int64_t origin = INT64_MAX;
+    double length = Timer::tickLength() / 1000; // Microseconds per tick
+    bool first = true;
+
+    if(!out)
+        return false;
+
+    for(const std::unique_ptr<tTraceBuffer> &buffer : buffers)
+        if(!buffer->events.empty())
+            origin = std::min(origin, buffer->events.front().ticks);
+
+    out.precision(15);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    for(const std::unique_ptr<tTraceBuffer> &buffer : buffers){
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+            << ",\"args\":{\"name\":\"Thread " << buffer->thread << "\"}}";
+        first = false;
+
+        for(const tTraceEvent &event : buffer->events){
+            out << ",\n{\"name\":";
+            writeName(out, event.name);
+            out << ",\"ph\":\"" << event.phase << "\",\"ts\":" << (event.ticks - origin) * length
+                << ",\"pid\":1,\"tid\":" << buffer->thread << "}";
+        }
+    }
+
+    out << "\n]}\n";
+
+    return (bool) out;
+}
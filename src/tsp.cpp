@@ -1,92 +1,434 @@
 #include "include/tsp.h"
 
-TSP::TSP(double ***matrix_pointer, int dimension, int iterations): MetaheuristicProblem(matrix_pointer, dimension){
+#include <deque>
+
+TSP::TSP(double ***matrix_pointer, int dimension, const tParameters &params): MetaheuristicProblem(matrix_pointer, dimension, params){
+    configure(params_);
+}
+
+TSP::TSP(const Instance &instance, const tParameters &params): MetaheuristicProblem(instance, params){
+    configure(params_);
+}
+
+// Builds the neighborhood table of the parameters, the move caches of the previous one are kept for their buffers
+void TSP::configure(const tParameters &params){
+    std::vector<tNeighborhood<TSP>> table;
+
+    MetaheuristicProblem::configure(params);
+
+    // Neighborhood table, the moves that reverse a path add its cost change on asymmetric matrices
+    if(params_.asymmetric)
+        table = {{&TSP::swap, "Swap"}, {&TSP::revert<true>, "2-opt"}};
+    else
+        table = {{&TSP::swap, "Swap"}, {&TSP::revert<false>, "2-opt"}};
+    tOrOptTable<TSP, OROPT_MAX>::fill(table, std::max(1, std::min(params_.oropt_max, OROPT_MAX)));
+    tReversedOrOptTable<TSP, OROPT_MAX>::fill(table, std::max(1, std::min(params_.oropt_max, OROPT_MAX)));
+    if(params_.asymmetric)
+        table.push_back({&TSP::or2h<true>, "Or-2h"});
+    else
+        table.push_back({&TSP::or2h<false>, "Or-2h"});
+
+    for(int i = 0; i < table.size() && i < neighborhoods_.size(); i++)
+        std::swap(table[i].cache, neighborhoods_[i].cache);
+
+    neighborhoods_.swap(table);
+}
+
+// The table depends on whether the matrix is asymmetric
+void TSP::setInstance(const Instance &instance){
+    MetaheuristicProblem::setInstance(instance);
+    configure(params_);
+}
+
+void TSP::solve(){
+    reset();
+    s_.route.clear();
     final_.cost = INFINITY;
+    elite_.clear();
+
+    // The cached moves were evaluated on an earlier route
+    for(tNeighborhood<TSP> &neighborhood : neighborhoods_)
+        neighborhood.cache.route.clear();
     
     // Defining variables
-    int i, max_iterations = dimension_>=150 ? dimension_/2 : dimension_;
-    std::vector<char> neighbor_list;
+    int i, max_iterations = params_.stagnation ? params_.stagnation : (dimension_>=150 ? dimension_/2 : dimension_),
+        restarts = params_.restarts ? params_.restarts : TSP_IMAX;
+    long iteration = 0;
+    int merge_slot, perturb_slot;
+    bool two_level = params_.tour == 'l' || (params_.tour != 'a' && dimension_ >= TWOLEVEL_DIMENSION);
+    char construction = params_.construction ? params_.construction : (dimension_ >= CONSTRUCTION_DIMENSION ? 'g' : 'c');
+    LocalSearch *engine = NULL; // Replaces the RVND when set
+
+    if(params_.decomposition > 0 && dimension_ >= 2 * params_.decomposition){
+        decompose();
+        timer_.stop();
+        return;
+    }
+
+    // The candidate list searches assume a symmetric matrix
+    if(params_.local_search == 'l' && !params_.asymmetric && dimension_ >= LK_MIN_DIMENSION){
+        timer_.setTime(0);
+        if(neighbors_.empty())
+            buildNeighbors(params_.neighbors);
+        timer_.setTime(0);
+
+        if(two_level)
+            engine = new LinKernighan<TwoLevelTour>(matrix_, neighbors_, dimension_, [this](){ return timeUp(); });
+        else
+            engine = new LinKernighan<ArrayTour>(matrix_, neighbors_, dimension_, [this](){ return timeUp(); });
+
+        timer_.setLabel(1, "Lin-Kernighan");
+    }
+    else{
+        for(i = 0; i < neighborhoods_.size(); i++)
+            timer_.setLabel(i+1, neighborhoods_[i].label);
+
+        if(!params_.asymmetric && dimension_ >= DESCENT_DIMENSION){
+            timer_.setTime(0);
+            if(neighbors_.empty())
+                buildNeighbors(params_.neighbors);
+            timer_.setTime(0);
+        }
+    }
+
+    merge_slot = (engine != NULL ? 1 : neighborhoods_.size()) + 1;
+    if(params_.elite > 0)
+        timer_.setLabel(merge_slot, "Tour merging");
+
+    perturb_slot = merge_slot + 1;
+    timer_.setLabel(perturb_slot, "Perturbation");
 
     // GILS
-    for(int i_max = 0; i_max < iterations; i_max++){
-        s_.cost = 0;
+    for(int i_max = 0; i_max < restarts; i_max++){
+        if(traceEnabled())
+            traceBegin("Restart");
 
-        // Filling up the candidate list
-        for(i = 0; i < dimension_; i++)
-            candidate_list_.push_back(i);
+        s_.cost = 0;
 
         // Construction
         timer_.setTime(0);
-        
-        subtour(); // Creating a initial subtour
-        initialRoute(); // Filling up the solution vector feasibly
 
-        timer_.setTime(0);
+        if(i_max == 0 && params_.initial != NULL){
+            s_.route = *params_.initial;
+            s_.cost = getSolutionCost(s_);
+        }
+        else if(construction == 'c'){
+            // Filling up the candidate list
+            for(i = 0; i < dimension_; i++)
+                candidate_list_.push_back(i);
+
+            subtour(); // Creating a initial subtour
+            initialRoute(); // Filling up the solution vector feasibly
+        }
+        else{
+            fastRoute(construction, random(dimension_)-1, s_.route);
+            s_.cost = getSolutionCost(s_);
+        }
+
+        // Cheap improvement on the candidate lists before the full neighborhoods take over
+        if(engine == NULL && !params_.asymmetric && dimension_ >= DESCENT_DIMENSION){
+            if(two_level)
+                twoOptDescent<TwoLevelTour>();
+            else
+                twoOptDescent<ArrayTour>();
+        }
+
+        instrumentation_.record(0, false, 0, timer_.setTime(0));
 
         best_.cost = INFINITY;
 
-        // RVND
-        for(int i_ils = 0; i_ils < max_iterations; i_ils++){
-            neighbor_list = DEFAULT_NEIGHBORLIST;
-            while(!neighbor_list.empty()){
-                i = random(neighbor_list.size())-1;
-                switch(neighbor_list[i]){
-                    case 1:
-                        if(!swap())
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 2:
-                        if(!revert())
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 3:
-                        if(!reinsert(1))
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 4:
-                        if(!reinsert(2))
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-
-                    case 5:
-                        if(!reinsert(3))
-                            neighbor_list.erase(neighbor_list.begin() + i);
-                        else if(neighbor_list.size() != NEIGHBORLIST_SIZE)
-                            neighbor_list = DEFAULT_NEIGHBORLIST;
-                        break;
-                }
+        // ILS
+        for(int i_ils = 0; i_ils < max_iterations; i_ils++, iteration++){
+            if(engine != NULL){
+                // After the first iteration s_ is a perturbed best_, so only the nodes around the perturbation start active
+                timer_.setTime(1);
+                double delta = engine->optimize(s_.route, best_.cost < INFINITY ? &best_.route : NULL);
+                instrumentation_.record(1, delta < 0, -delta, timer_.setTime(1));
+                s_.cost += delta;
             }
+            else
+                rvnd(neighborhoods_.size());
+
             if(s_.cost < best_.cost){
                 best_ = s_;
                 i_ils = 0;
+
+                if(best_.cost < final_.cost){
+                    final_ = best_;
+                    newIncumbent(final_.route, final_.cost, iteration);
+                }
             }
             else
                 s_ = best_;
 
-            perturb();
+            if(stop(best_.cost))
+                break;
+
+            timer_.setTime(perturb_slot);
+            perturb(i_ils);
+            instrumentation_.record(perturb_slot, false, 0, timer_.setTime(perturb_slot));
         }
-        if(best_.cost < final_.cost){
-            final_ = best_;
-            std::cout << "New minimum: " << final_.cost << "\n";
+
+        // Recombining the pool whenever a new optimum joins it
+        if(params_.elite > 0 && updateElite(best_) && elite_.size() > 1 && !stop(final_.cost)){
+            double cost = final_.cost;
+            bool improved;
+
+            timer_.setTime(merge_slot);
+            if((improved = mergeElite() && s_.cost < final_.cost)){
+                final_ = s_;
+                newIncumbent(final_.route, final_.cost, iteration);
+                updateElite(s_);
+            }
+            instrumentation_.record(merge_slot, improved, cost - final_.cost, timer_.setTime(merge_slot));
         }
 
         s_.route.clear();
+
+        if(traceEnabled())
+            traceEnd("Restart");
+
+        if(stop(final_.cost))
+            break;
     }
     
+    delete engine;
+
     timer_.stop();
 }
 
+// Decomposition mode: the tour is cut into segments of params_.decomposition nodes, optimized in parallel as paths
+// with fixed ends, and the cuts are shifted by half a segment every round (POPMUSIC style)
+void TSP::decompose(){
+    char construction = params_.construction && params_.construction != 'c' ? params_.construction : 'g';
+    int idle = 0;
+    long round = 0;
+    double cost;
+
+    timer_.setLabel(1, "Decomposition");
+
+    timer_.setTime(0);
+    if(params_.initial != NULL)
+        s_.route = *params_.initial;
+    else
+        fastRoute(construction, random(dimension_)-1, s_.route);
+    s_.cost = getSolutionCost(s_);
+    timer_.setTime(0);
+
+    // A first Lin-Kernighan pass over the whole tour, so the segments start out spatially compact
+    if(params_.local_search == 'l' && !params_.asymmetric){
+        bool two_level = params_.tour == 'l' || (params_.tour != 'a' && dimension_ >= TWOLEVEL_DIMENSION);
+        LocalSearch *engine;
+
+        timer_.setTime(0);
+        if(neighbors_.empty())
+            buildNeighbors(params_.neighbors);
+
+        if(two_level)
+            engine = new LinKernighan<TwoLevelTour>(matrix_, neighbors_, dimension_, [this](){ return timeUp(); });
+        else
+            engine = new LinKernighan<ArrayTour>(matrix_, neighbors_, dimension_, [this](){ return timeUp(); });
+
+        s_.cost += engine->optimize(s_.route);
+        delete engine;
+        timer_.setTime(0);
+    }
+
+    final_ = s_;
+    newIncumbent(final_.route, final_.cost, round);
+
+    Decomposition decomposition(matrix_, dimension_, params_, rng_());
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    if(params_.time_limit > 0)
+        deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>(params_.time_limit - timer_.getElapsedTime()));
+
+    timer_.setTime(1);
+    while(idle < DECOMPOSITION_IDLE && !stop(final_.cost)){
+        decomposition.round(s_.route, params_.decomposition / 2, deadline);
+        round++;
+
+        if((cost = getSolutionCost(s_)) < final_.cost - IMPROVEMENT_EPSILON){
+            s_.cost = cost;
+            final_ = s_;
+            newIncumbent(final_.route, final_.cost, round);
+            idle = 0;
+        }
+        else
+            idle++;
+    }
+    timer_.setTime(1);
+}
+
+// Inserts the solution into the elite pool unless it is already there or worse than all of the params_.elite kept.
+// Two tours are the same if they have the same edges. Returns true if the pool changed
+bool TSP::updateElite(const tSolution<double> &solution){
+    std::vector<int> next(dimension_), prev(dimension_);
+
+    if(elite_.size() == params_.elite && solution.cost >= elite_.back().cost)
+        return false;
+
+    for(int i = 0; i < dimension_; i++){
+        next[solution.route[i]] = solution.route[i+1];
+        prev[solution.route[i+1]] = solution.route[i];
+    }
+
+    for(tSolution<double> &elite : elite_){
+        if(std::abs(elite.cost - solution.cost) > IMPROVEMENT_EPSILON)
+            continue;
+
+        int i = 0;
+        while(i < dimension_ && (next[elite.route[i]] == elite.route[i+1] || prev[elite.route[i]] == elite.route[i+1]))
+            i++;
+
+        if(i == dimension_)
+            return false;
+    }
+
+    auto position = std::upper_bound(elite_.begin(), elite_.end(), solution,
+        [](const tSolution<double> &a, const tSolution<double> &b) -> bool{
+            return a.cost < b.cost;
+        }
+    );
+
+    elite_.insert(position, solution);
+    if(elite_.size() > params_.elite)
+        elite_.pop_back();
+
+    return true;
+}
+
+// Tour merging: the edges shared by every elite tour are fixed and each path they form is contracted to its two ends.
+// The reduced TSP, in which the edge between the ends of a path costs nothing and every other edge at an end costs
+// more than any tour, is solved from the best elite tour and expanded back into s_. Returns true if s_ is set
+bool TSP::mergeElite(){
+    const std::vector<int> &best = elite_[0].route;
+    std::vector<int> next(dimension_), prev(dimension_), 
+                     ends,          // Node of each reduced node
+                     pair,          // The other end of its path, -1 for a single node
+                     first, last;   // Positions of its path in the best tour, from this end to the other one
+    std::vector<char> forward,              // Whether the path follows the best tour from this end
+                      fixed(dimension_, true); // Whether the edge from the position on is in every elite tour
+
+    for(int e = 1; e < elite_.size(); e++){
+        for(int i = 0; i < dimension_; i++){
+            next[elite_[e].route[i]] = elite_[e].route[i+1];
+            prev[elite_[e].route[i+1]] = elite_[e].route[i];
+        }
+
+        for(int i = 0; i < dimension_; i++)
+            if(next[best[i]] != best[i+1] && prev[best[i]] != best[i+1])
+                fixed[i] = false;
+    }
+
+    // Starting at a path end, so no path wraps around the route
+    int start = std::find(fixed.begin(), fixed.end(), false) - fixed.begin();
+    if(start == dimension_)
+        return false;
+    start = (start + 1) % dimension_;
+
+    for(int k = 0; k < dimension_; ){
+        int from = (start + k) % dimension_, to = from;
+
+        while(fixed[to])
+            to = (to + 1) % dimension_;
+        k += (to - from + dimension_) % dimension_ + 1;
+
+        int r = ends.size();
+        ends.push_back(best[from]);
+        first.push_back(from);
+        last.push_back(to);
+        forward.push_back(true);
+        pair.push_back(-1);
+
+        if(to != from){
+            ends.push_back(best[to]);
+            first.push_back(to);
+            last.push_back(from);
+            forward.push_back(false);
+            pair.push_back(r);
+            pair[r] = r+1;
+        }
+    }
+
+    int size = ends.size();
+    std::vector<double> storage(size * size);
+    std::vector<double*> rows(size);
+    std::vector<int> initial(size+1);
+    double **matrix = rows.data(),
+           longest = 0;
+
+    if(size < LK_MIN_DIMENSION)
+        return false;
+
+    for(int r = 0; r < size; r++){
+        rows[r] = &storage[r * size];
+
+        for(int c = 0; c < size; c++){
+            matrix[r][c] = matrix_[ends[r]][ends[c]];
+            longest = std::max(longest, matrix[r][c]);
+        }
+    }
+
+    double big = size * longest + 1;
+
+    for(int r = 0; r < size; r++)
+        for(int c = 0; c < size; c++){
+            if(c == r)
+                continue;
+            else if(c == pair[r])
+                matrix[r][c] = 0;
+            else
+                matrix[r][c] += big * ((pair[r] >= 0) + (pair[c] >= 0));
+        }
+
+    // The reduced nodes follow the best tour
+    std::iota(initial.begin(), initial.end()-1, 0);
+    initial[size] = 0;
+
+    tParameters params = params_;
+    params.quiet = true;
+    params.observer = nullptr;
+    params.x = params.y = NULL;
+    params.elite = params.decomposition = 0;
+    params.restarts = 1;
+    params.target = params.gap_limit = 0;
+    params.time_limit = params_.time_limit > 0 ? std::max(1e-3, params_.time_limit - timer_.getElapsedTime()) : 0;
+    params.seed = rng_();
+    params.initial = &initial;
+
+    TSP reduced(&matrix, size, params);
+    reduced.solve();
+    std::vector<int> result(reduced.getRoute().begin(), reduced.getRoute().end()-1);
+
+    // Node 0 is a path start, it must be followed by its other end
+    std::rotate(result.begin(), std::find(result.begin(), result.end(), 0), result.end());
+    if(pair[0] >= 0 && result[1] != pair[0])
+        std::reverse(result.begin()+1, result.end());
+
+    s_.route.clear();
+    for(int k = 0; k < size; k++){
+        int r = result[k];
+
+        if(pair[r] >= 0 && (k+1 == size || result[k+1] != pair[r]))
+            return false;
+
+        for(int i = first[r]; ; i = forward[r] ? (i + 1) % dimension_ : (i - 1 + dimension_) % dimension_){
+            s_.route.push_back(best[i]);
+            if(i == last[r])
+                break;
+        }
+
+        if(pair[r] >= 0)
+            k++;
+    }
+    s_.route.push_back(s_.route[0]);
+    s_.cost = getSolutionCost(s_);
+
+    return s_.cost < elite_[0].cost - IMPROVEMENT_EPSILON;
+}
+
 void TSP::subtour(){
     //Obtaining an initial item randomly
     int first = random(dimension_-1);
@@ -111,6 +453,19 @@ void TSP::subtour(){
 void TSP::initialRoute(){    
     //Repeating until a feasible initial solution is found
     while (!candidate_list_.empty()){
+        //Out of time, the remaining candidates are appended before the last node
+        if(timeUp()){
+            int last = s_.route.size()-1;
+
+            s_.cost -= matrix_[s_.route[last-1]][s_.route[last]];
+            s_.route.insert(s_.route.begin() + last, candidate_list_.begin(), candidate_list_.end());
+            candidate_list_.clear();
+
+            for(int i = last-1; i < s_.route.size()-1; i++)
+                s_.cost += matrix_[s_.route[i]][s_.route[i+1]];
+            break;
+        }
+
         //Calculating the insertion cost of each one of the remaining candidates
         tMove<double> cost_vector[(s_.route.size()-2) * candidate_list_.size()];
 
@@ -130,8 +485,8 @@ void TSP::initialRoute(){
         //Sorting the cost_vector
         std::sort(&cost_vector[0], &cost_vector[(s_.route.size()-2) * candidate_list_.size()]);
         
-        //Obtaining an item in a random interval of the cost_vector
-        tMove<double>* next_node = &cost_vector[random((int)random(10)/10.0 * (((s_.route.size()-2) * candidate_list_.size())- 1))];
+        //Obtaining an item in a random interval of the cost_vector, the interval is never empty on small instances
+        tMove<double>* next_node = &cost_vector[random(std::max(1, (int)(random(10)/10.0 * (((s_.route.size()-2) * candidate_list_.size())- 1))))];
 
         //Inserting the item into the solution and removing it from the candidate list
         s_.route.insert(s_.route.begin() + (next_node->j) + 1, candidate_list_[next_node->i]);
@@ -140,137 +495,264 @@ void TSP::initialRoute(){
     }
 }
 
-// A function that searches for the best nodes i and j to swap 
-bool TSP::swap(){ 
-    tMove<double> best_swap = {0, 0, INFINITY};  //Here we set the cost to INFINITY
-    double delta, rm_delta;
+// Runs the index-th neighborhood of the table
+bool TSP::searchNeighborhood(int index){
+    if(params_.asymmetric)
+        updatePrefixSums();
 
-    timer_.setTime(1);
-    // Repeating until the swap with lowest delta is found
-    for(int i = 1; i < s_.route.size() - 2; i++){
-        rm_delta = -matrix_[s_.route[i]][s_.route[i-1]]
-                   -matrix_[s_.route[i]][s_.route[i+1]];
-        for(int j = i + 2; j < s_.route.size() - 1; j++){
-            delta =  rm_delta
-                    +matrix_[s_.route[i]][s_.route[j-1]]
+    return (this->*neighborhoods_[index].search)(neighborhoods_[index].cache);
+}
+
+// Computes the cost of every prefix of the route, followed forwards and backwards
+void TSP::updatePrefixSums(){
+    forward_.resize(s_.route.size());
+    backward_.resize(s_.route.size());
+    forward_[0] = backward_[0] = 0;
+
+    for(int i = 0; i < s_.route.size()-1; i++){
+        forward_[i+1] = forward_[i] + matrix_[s_.route[i]][s_.route[i+1]];
+        backward_[i+1] = backward_[i] + matrix_[s_.route[i+1]][s_.route[i]];
+    }
+}
+
+// A function that searches for the best nodes i and j to swap 
+bool TSP::swap(tMoveCache &cache){ 
+    int size = s_.route.size();
+
+    tMove<double> best_swap = cachedSearch(cache, s_.route, {-1, 1, -1, 1, false}, 1, size - 2,
+        [&](int i){ return std::make_pair(i + 2, size - 1); },
+        [&](int i, int j) -> double{
+            return  -matrix_[s_.route[i-1]][s_.route[i]]
+                    -matrix_[s_.route[i]][s_.route[i+1]]
+                    +matrix_[s_.route[j-1]][s_.route[i]]
                     +matrix_[s_.route[i]][s_.route[j+1]]
-                    +matrix_[s_.route[j]][s_.route[i-1]]
+                    +matrix_[s_.route[i-1]][s_.route[j]]
                     +matrix_[s_.route[j]][s_.route[i+1]]
-                    -matrix_[s_.route[j]][s_.route[j-1]]
+                    -matrix_[s_.route[j-1]][s_.route[j]]
                     -matrix_[s_.route[j]][s_.route[j+1]];
-            
-            if(delta < 0 && delta < best_swap.cost)
-                best_swap = {i, j, delta};
         }
-    }
+    );
 
     // Making the swap in the route and inserting the delta in the cost
     if(best_swap.cost < 0){
         s_.cost = s_.cost + best_swap.cost;
         std::swap(s_.route[best_swap.i], s_.route[best_swap.j]);
-        timer_.setTime(1);
         return true;
     }
 
-    timer_.setTime(1);
     return false;
 }
 
 // A function that searches for the best range [i,j] to reverse
-bool TSP::revert(){ 
-    tMove<double> best_reversion = {0, 0, INFINITY};
-    double delta;
-
-    timer_.setTime(2);
-    for(int i = 1; i < s_.route.size() - 3; i++){
-        for(int j = i + 1; j < s_.route.size() - 1; j++){
-            delta =  matrix_[s_.route[i]][s_.route[j+1]]
-                    +matrix_[s_.route[j]][s_.route[i-1]]
-                    -matrix_[s_.route[i]][s_.route[i-1]]
-                    -matrix_[s_.route[j]][s_.route[j+1]];
-            
-            if(delta < 0 && delta < best_reversion.cost)
-                best_reversion = {i, j, delta};
+template <bool Asymmetric>
+bool TSP::revert(tMoveCache &cache){ 
+    int size = s_.route.size();
+
+    // On asymmetric matrices the cost of the whole range changes
+    tMove<double> best_reversion = cachedSearch(cache, s_.route, {-1, 0, 0, 1, Asymmetric}, 1, size - 3,
+        [&](int i){ return std::make_pair(i + 1, size - 1); },
+        [&](int i, int j) -> double{
+            double delta =  matrix_[s_.route[i-1]][s_.route[j]]
+                           +matrix_[s_.route[i]][s_.route[j+1]]
+                           -matrix_[s_.route[i-1]][s_.route[i]]
+                           -matrix_[s_.route[j]][s_.route[j+1]];
+
+            if(Asymmetric)
+                delta += reversalDelta(i, j);
+
+            return delta;
         }
-    } 
+    );
 
     if(best_reversion.cost < 0){
         s_.cost = s_.cost + best_reversion.cost;
         std::reverse(s_.route.begin() + best_reversion.i, s_.route.begin() + best_reversion.j+1);
-        timer_.setTime(2);
         return true;
     }
 
-    timer_.setTime(2);
     return false;
 }
 
-// A function that searches for the best j position to reinsert a subsequence [i,num)
-bool TSP::reinsert(int num){ 
-    tMove<double> best_reinsertion = {0, 0, INFINITY};
-    double delta, rm_delta;
-
-    timer_.setTime(2+num);
-    for(int i = 1; i < s_.route.size() - num; i++){
-        rm_delta = matrix_[s_.route[i-1]][s_.route[i+num]]
-                  -matrix_[s_.route[i-1]][s_.route[i]]
-                  -matrix_[s_.route[i+(num-1)]][s_.route[i+num]];
-        for(int j = 1; j < s_.route.size() - num; j++){
+// A function that searches for the best j position to reinsert a subsequence [i,Num), reversed or not
+template <int Num, bool Reversed>
+bool TSP::reinsert(tMoveCache &cache){ 
+    int size = s_.route.size();
+
+    tMove<double> best_reinsertion = cachedSearch(cache, s_.route, {-1, Num, -1, Num, false}, 1, size - Num,
+        [&](int i){ return std::make_pair(1, size - Num); },
+        [&](int i, int j) -> double{
             // Checking if the j index is the same as the beginning of the subsequence
-            if(j != i){       
-                if(j > i)
-                    delta =  rm_delta
-                            +matrix_[s_.route[j+(num-1)]][s_.route[i]]
-                            +matrix_[s_.route[i+(num-1)]][s_.route[j+num]]
-                            -matrix_[s_.route[j+(num-1)]][s_.route[j+num]];
-                else
-                    delta =  rm_delta 
-                            +matrix_[s_.route[j-1]][s_.route[i]]
-                            +matrix_[s_.route[i+(num-1)]][s_.route[j]] 
-                            -matrix_[s_.route[j]][s_.route[j-1]];
-                
-                if(delta < 0 && delta < best_reinsertion.cost)
-                    best_reinsertion = {i, j, delta};
-            }
+            if(j == i)
+                return INFINITY;
+
+            double delta =  matrix_[s_.route[i-1]][s_.route[i+Num]]
+                           -matrix_[s_.route[i-1]][s_.route[i]]
+                           -matrix_[s_.route[i+(Num-1)]][s_.route[i+Num]];
+
+            if(Reversed && params_.asymmetric)
+                delta += reversalDelta(i, i+(Num-1));
+
+            if(j > i)
+                delta +=  matrix_[s_.route[j+(Num-1)]][s_.route[Reversed ? i+(Num-1) : i]]
+                         +matrix_[s_.route[Reversed ? i : i+(Num-1)]][s_.route[j+Num]]
+                         -matrix_[s_.route[j+(Num-1)]][s_.route[j+Num]];
+            else
+                delta +=  matrix_[s_.route[j-1]][s_.route[Reversed ? i+(Num-1) : i]]
+                         +matrix_[s_.route[Reversed ? i : i+(Num-1)]][s_.route[j]] 
+                         -matrix_[s_.route[j-1]][s_.route[j]];
+
+            return delta;
         }
-    }
+    );
     
     if(best_reinsertion.cost < 0){
         s_.cost = s_.cost + best_reinsertion.cost;
         
         if (best_reinsertion.i < best_reinsertion.j)
-            std::rotate(s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+num, s_.route.begin() + best_reinsertion.j+num);
+            std::rotate(s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+Num, s_.route.begin() + best_reinsertion.j+Num);
         else
-            std::rotate(s_.route.begin() + best_reinsertion.j, s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+num);
+            std::rotate(s_.route.begin() + best_reinsertion.j, s_.route.begin() + best_reinsertion.i, s_.route.begin() + best_reinsertion.i+Num);
+
+        // Either way the segment ends up at [j, j+Num)
+        if(Reversed)
+            std::reverse(s_.route.begin() + best_reinsertion.j, s_.route.begin() + best_reinsertion.j+Num);
 
-        timer_.setTime(2+num);
         return true;
     }
 
-    timer_.setTime(2+num);
     return false;
 }
 
-// A function that perturbs the solution using the Double-bridge method
-void TSP::perturb(){
-    int i_size = random(ceil(dimension_/10.0)-1),    //min = 1 & max = dimension_/10 - 1
-        j_size = random(ceil(dimension_/10.0)-1);
+// Cost changes of the two Or-2h moves over [i,j]: B = [i, i+1] after C = [i+2, j] and B = [j-1, j] before C = [i, j-2]
+template <bool Asymmetric>
+std::pair<double, double> TSP::or2hDeltas(int i, int j){
+    double forward =  matrix_[s_.route[i-1]][s_.route[j]]
+                     +matrix_[s_.route[i+2]][s_.route[i]]
+                     +matrix_[s_.route[i+1]][s_.route[j+1]]
+                     -matrix_[s_.route[i-1]][s_.route[i]]
+                     -matrix_[s_.route[i+1]][s_.route[i+2]]
+                     -matrix_[s_.route[j]][s_.route[j+1]],
+           backward =  matrix_[s_.route[i-1]][s_.route[j-1]]
+                      +matrix_[s_.route[j]][s_.route[j-2]]
+                      +matrix_[s_.route[i]][s_.route[j+1]]
+                      -matrix_[s_.route[i-1]][s_.route[i]]
+                      -matrix_[s_.route[j-2]][s_.route[j-1]]
+                      -matrix_[s_.route[j]][s_.route[j+1]];
+
+    if(Asymmetric){
+        forward += reversalDelta(i+2, j);
+        backward += reversalDelta(i, j-2);
+    }
+
+    return std::make_pair(forward, backward);
+}
+
+// A function that searches for the best 3-opt move that takes a pair of nodes B over a segment C, reversing C:
+// A B C D -> A C' B D (or A C B D -> A B C' D). A reversed C keeps it apart from the Or-opt moves
+template <bool Asymmetric>
+bool TSP::or2h(tMoveCache &cache){
+    int size = s_.route.size();
+
+    tMove<double> best_move = cachedSearch(cache, s_.route, {-1, 2, -2, 1, Asymmetric}, 1, size - 4,
+        [&](int i){ return std::make_pair(i + 3, size - 1); },
+        [&](int i, int j) -> double{
+            std::pair<double, double> deltas = or2hDeltas<Asymmetric>(i, j);
+            return std::min(deltas.first, deltas.second);
+        }
+    );
+
+    if(best_move.cost < 0){
+        std::pair<double, double> deltas = or2hDeltas<Asymmetric>(best_move.i, best_move.j);
+        bool forward = deltas.first <= deltas.second;
+
+        s_.cost = s_.cost + best_move.cost;
+
+        // Reversing [i,j] reverses both C and B, so B is turned back
+        std::reverse(s_.route.begin() + best_move.i, s_.route.begin() + best_move.j+1);
+        if(forward)
+            std::reverse(s_.route.begin() + best_move.j-1, s_.route.begin() + best_move.j+1);
+        else
+            std::reverse(s_.route.begin() + best_move.i, s_.route.begin() + best_move.i+2);
+
+        return true;
+    }
+
+    return false;
+}
+
+// A function that applies improving 2-opt moves between candidate list neighbors until there are none left.
+// Only the nodes around the last changes are kept active (don't-look bits)
+template <class Tour>
+void TSP::twoOptDescent(){
+    Tour tour(dimension_);
+    std::deque<int> queue(s_.route.begin(), s_.route.end()-1);
+    std::vector<char> active(dimension_, true);
+    double delta;
+
+    tour.build(s_.route);
+
+    while(!queue.empty() && !timeUp()){
+        int a = queue.front();
+        bool improved = false;
 
-    int i = random(dimension_ - (i_size+j_size+2)),
-        j = random(dimension_ - (i+i_size+j_size+1)) + (i+i_size);
+        queue.pop_front();
+        active[a] = false;
 
-    std::vector<int> sub_route1(s_.route.begin() + i, s_.route.begin() + i + i_size + 1),
-                     sub_route2(s_.route.begin() + j, s_.route.begin() + j + j_size + 1);
+        // Trying to replace the edge to the successor, then the edge to the predecessor of a
+        for(int direction = 0; direction < 2 && !improved; direction++){
+            int b = direction ? tour.prev(a) : tour.next(a);
+
+            for(int k = 0; k < neighbors_[a].size(); k++){
+                int c = neighbors_[a][k];
+
+                // The new edge (a,c) must be shorter than the removed one
+                if(matrix_[a][c] >= matrix_[a][b])
+                    break;
+
+                int d = direction ? tour.prev(c) : tour.next(c);
+                if(c == b || d == a)
+                    continue;
+
+                delta =  matrix_[a][c] + matrix_[b][d]
+                        -matrix_[a][b] - matrix_[c][d];
+
+                if(delta < -IMPROVEMENT_EPSILON){
+                    if(direction)
+                        tour.flip(b, a, d, c);
+                    else
+                        tour.flip(a, b, c, d);
+
+                    s_.cost += delta;
+
+                    int changed[] = {a, b, c, d};
+                    for(int node : changed)
+                        if(!active[node]){
+                            active[node] = true;
+                            queue.push_back(node);
+                        }
+
+                    improved = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    tour.getRoute(s_.route, s_.route[0]);
+}
+
+// A function that perturbs the solution using the Double-bridge method
+void TSP::perturb(int stagnation){
+    int i, i_size, j, j_size;
+
+    bridgeSegments(s_.route, stagnation, i, i_size, j, j_size);
 
     s_.cost -=  matrix_[s_.route[i-1]][s_.route[i]]
                +matrix_[s_.route[i+i_size]][s_.route[i+i_size+1]]
                +((i+i_size+1 == j)? 0 : matrix_[s_.route[j-1]][s_.route[j]])   //Checks if the subsequences are adjacent
                +matrix_[s_.route[j+j_size]][s_.route[j+j_size+1]];
 
-    s_.route.erase(s_.route.begin() + j, s_.route.begin() + j + j_size + 1);
-    s_.route.erase(s_.route.begin() + i, s_.route.begin() + i + i_size + 1);
-    s_.route.insert(s_.route.begin() + i, sub_route2.begin(), sub_route2.end());
-    s_.route.insert(s_.route.begin() + j + (j_size - i_size), sub_route1.begin(), sub_route1.end());
+    swapSegments(s_.route, i, i_size, j, j_size);
 
     s_.cost +=  matrix_[s_.route[i-1]][s_.route[i]]
                +matrix_[s_.route[i+j_size]][s_.route[i+j_size+1]]
@@ -278,10 +760,19 @@ void TSP::perturb(){
                +matrix_[s_.route[j+j_size]][s_.route[j+j_size+1]];
 }
 
+// Returns the cost of the solution being improved
+double TSP::getCurrentCost(){
+    return s_.cost;
+}
+
 tSolution<double> TSP::getSolution(){
     return final_;
 }
 
+const std::vector<int>& TSP::getRoute(){
+    return final_.route;
+}
+
 // Returns the final cost
 double TSP::getCost(){
     return final_.cost;
@@ -307,4 +798,4 @@ double TSP::getSolutionCost(tSolution<double> &solution){
 
 void TSP::printSolution(){
     printRoute(final_.route);
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "../src/include/osolver.h"
+#include "check.h"
+
+#include <cmath>
+
+// A structure that names a small TSPLIB instance and its optimal tour cost
+struct tOptimum{
+    const char *path;
+    double cost;
+};
+
+// The Branch and Bound has to prove these optima in a few seconds, with both assignment solvers
+int main(){
+    const tOptimum optima[] = {{"instances/burma14.tsp", 3323}, {"instances/ulysses16.tsp", 6859},
+                               {"instances/bays29.tsp", 2020}};
+
+    for(const tOptimum &optimum : optima){
+        Instance instance(optimum.path);
+
+        for(char assignment : {'j', 'h'}){
+            tParameters params;
+            std::string name = std::string(optimum.path) + " --assignment=" + assignment;
+
+            // ulysses16 takes a while with the Hungarian method
+            if(assignment == 'h' && instance.getDimension() == 16)
+                continue;
+
+            params.quiet = true;
+            params.seed = 1;
+            params.assignment = assignment;
+            instance.apply(params);
+
+            BB bb(instance, params);
+            bb.solve();
+            tResult result = bb.result();
+
+            check(std::abs(result.cost - optimum.cost) < 1e-6, name + ": cost " + std::to_string(result.cost));
+            check(result.route.size() == instance.getDimension() + 1 && result.route.front() == result.route.back(),
+                  name + ": not a closed tour");
+        }
+    }
+
+    return report("bb");
+}
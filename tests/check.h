@@ -0,0 +1,22 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+#include <string>
+
+// The checks of a test program. Every failed one is printed, and the program exits with their number
+static int failures = 0;
+
+inline void check(bool condition, const std::string &what){
+    if(!condition){
+        std::cout << "FAILED: " << what << "\n";
+        failures++;
+    }
+}
+
+inline int report(const char *test){
+    std::cout << test << ": " << (failures ? std::to_string(failures) + " failed" : std::string("ok")) << "\n";
+    return failures;
+}
+
+#endif // CHECK_H
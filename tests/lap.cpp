@@ -0,0 +1,129 @@
+#include "../src/include/lap.h"
+#include "../src/include/hungarian.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#define LAP_MATRICES 1000   // Random matrices of each kind
+#define LAP_TOLERANCE 1e-6  // Largest error on the cost and the duals of double matrices
+
+// The solution has to assign every column once, cost what solve() returned and be optimal by the duals: feasible
+// (u_i + v_j <= c_ij) and tight on the assigned cells
+template <typename T>
+bool certified(const LinearAssignment<T> &lap, const std::vector<T> &costs, T cost){
+    int n = lap.getDimension();
+    const std::vector<int> &assignment = lap.getAssignment();
+    std::vector<bool> taken(n, false);
+    double sum = 0;
+
+    for(int i = 0; i < n; i++){
+        if(assignment[i] < 0 || assignment[i] >= n || taken[assignment[i]])
+            return false;
+        taken[assignment[i]] = true;
+        sum += costs[i*n + assignment[i]];
+
+        for(int j = 0; j < n; j++){
+            double reduced = costs[i*n + j] - lap.getRowDuals()[i] - lap.getColumnDuals()[j];
+
+            if(reduced < -LAP_TOLERANCE || (j == assignment[i] && reduced > LAP_TOLERANCE))
+                return false;
+        }
+    }
+
+    return std::abs(sum - cost) <= LAP_TOLERANCE * std::max(1.0, std::abs(sum));
+}
+
+// The optimum over every permutation, for the smallest matrices
+double bruteForce(const std::vector<double> &costs, int n){
+    std::vector<int> permutation(n);
+    double best = INFINITY;
+
+    std::iota(permutation.begin(), permutation.end(), 0);
+    do{
+        double sum = 0;
+        for(int i = 0; i < n; i++)
+            sum += costs[i*n + permutation[i]];
+        best = std::min(best, sum);
+    }while(std::next_permutation(permutation.begin(), permutation.end()));
+
+    return best;
+}
+
+// Integer matrices, some with few distinct values (ties) and some with the forbidden diagonal of the BB, against
+// libhungarian. Each solver is reused, as in the BB
+void integerCosts(std::mt19937 &rng){
+    for(int t = 0; t < LAP_MATRICES; t++){
+        int n = 1 + rng() % 40,
+            range = t % 3 == 0 ? 3 : t % 3 == 1 ? 100 : 100000;
+        std::vector<double> costs(n*n);
+        std::vector<int64_t> integers(n*n);
+        std::vector<double*> rows(n);
+        hungarian_problem_t p;
+
+        for(int i = 0; i < n; i++){
+            rows[i] = &costs[i*n];
+            for(int j = 0; j < n; j++)
+                integers[i*n + j] = costs[i*n + j] = i == j && t % 2 ? 999999999 : rng() % range;
+        }
+
+        hungarian_init(&p, rows.data(), n, n, HUNGARIAN_MODE_MINIMIZE_COST);
+        int optimum = hungarian_solve(&p);
+        hungarian_free(&p);
+
+        LinearAssignment<double> doubles(n);
+        LinearAssignment<int64_t> int64s(n);
+        std::string name = "integer matrix " + std::to_string(t) + " of dimension " + std::to_string(n);
+
+        for(int r = 0; r < 2; r++){
+            double cost = doubles.solve(costs.data());
+            int64_t cost64 = int64s.solve(integers.data());
+
+            check(cost == optimum && certified(doubles, costs, cost), name + " (double)");
+            check(cost64 == optimum && certified(int64s, integers, cost64), name + " (int64_t)");
+        }
+    }
+}
+
+// Fractional matrices, on which the row reduction used to run forever: sevenths, square roots and hundredths. The
+// smallest ones against every permutation, the hundredths against the integer solver on the costs times 100
+void fractionalCosts(std::mt19937 &rng){
+    for(int t = 0; t < 3 * LAP_MATRICES; t++){
+        int kind = t % 3,
+            n = 2 + rng() % (t % 2 ? 60 : 7);
+        std::vector<double> costs(n*n);
+        std::vector<int64_t> hundredths(n*n);
+        std::string name = "fractional matrix " + std::to_string(t) + " of dimension " + std::to_string(n);
+
+        for(int k = 0; k < n*n; k++){
+            int r = rng() % 1000;
+
+            costs[k] = kind == 0 ? r / 7.0 : kind == 1 ? std::sqrt((double)r) : r * 0.01;
+            hundredths[k] = r;
+        }
+
+        LinearAssignment<double> lap(n);
+        double cost = lap.solve(costs.data());
+
+        check(certified(lap, costs, cost), name);
+
+        if(n <= 8)
+            check(std::abs(cost - bruteForce(costs, n)) <= LAP_TOLERANCE, name + " against every permutation");
+
+        if(kind == 2){
+            LinearAssignment<int64_t> integers(n);
+            check(std::abs(cost - integers.solve(hundredths.data()) * 0.01) <= LAP_TOLERANCE, name + " times 100");
+        }
+    }
+}
+
+int main(){
+    std::mt19937 rng(5);
+
+    integerCosts(rng);
+    fractionalCosts(rng);
+
+    return report("lap");
+}
@@ -0,0 +1,137 @@
+#include "../src/include/mlp.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#define NEIGHBORHOOD_ROUTES 20       // Random routes each neighborhood descends from, on each matrix
+#define NEIGHBORHOOD_TOLERANCE 1e-6  // Largest error of a predicted cost change
+
+// Sum of the arrival times at every position, the return to the depot included
+double latencyCost(double **matrix, const std::vector<int> &route){
+    double time = 0,
+           cost = 0;
+
+    for(int k = 0; k+1 < route.size(); k++){
+        time += matrix[route[k]][route[k+1]];
+        cost += time;
+    }
+
+    return cost;
+}
+
+// A class that runs the MLP neighborhoods on routes of its own. Each neighborhood applies its best move until none
+// improves, and every move has to change the cost by what its search predicted, the smallest delta left in the move
+// cache, and leave the cost of the route it computed equal to the latency of the new route
+class NeighborhoodCheck{
+    MLP &mlp_;
+    double **matrix_;
+
+    void setRoute(const std::vector<int> &route){
+        mlp_.s_.route = route;
+        mlp_.s_.cost[0][0] = {0, 0, 0};
+        mlp_.s_.cost[mlp_.s_.LAST][mlp_.s_.LAST] = {0, 0, 0};
+
+        for(int i = 1; i < route.size(); i++)
+            mlp_.s_.cost[i][i] = {1, 0, 0};
+
+        mlp_.fillCost();
+    }
+
+    public:
+        NeighborhoodCheck(MLP &mlp, double **matrix): mlp_(mlp), matrix_(matrix){}
+
+        int neighborhoods() const{
+            return mlp_.neighborhoods_.size();
+        }
+
+        void descend(int index, const std::vector<int> &route, const std::string &matrix){
+            tMoveCache &cache = mlp_.neighborhoods_[index].cache;
+            std::string name = mlp_.neighborhoods_[index].label + " on the " + matrix + " matrix";
+
+            setRoute(route);
+            cache.route.clear();
+
+            for(int moves = 0; moves < route.size() * route.size(); moves++){
+                double cost = mlp_.s_.cost[0][mlp_.s_.LAST].c;
+
+                if(!mlp_.searchNeighborhood(index))
+                    break;
+
+                double predicted = std::min_element(cache.rows.begin(), cache.rows.end())->cost,
+                       actual = mlp_.s_.cost[0][mlp_.s_.LAST].c - cost,
+                       latency = latencyCost(matrix_, mlp_.s_.route);
+
+                check(std::abs(predicted - actual) <= NEIGHBORHOOD_TOLERANCE * std::max(1.0, cost),
+                      name + ": predicted " + std::to_string(predicted) + ", the move changed the cost by "
+                      + std::to_string(actual));
+                check(std::abs(latency - mlp_.s_.cost[0][mlp_.s_.LAST].c) <= NEIGHBORHOOD_TOLERANCE * std::max(1.0, cost),
+                      name + ": cost " + std::to_string(mlp_.s_.cost[0][mlp_.s_.LAST].c) + ", the route costs "
+                      + std::to_string(latency));
+            }
+        }
+};
+
+// Descends random routes with every neighborhood, with and without the move cache
+void checkMatrix(std::vector<std::vector<double>> &costs, const std::string &name, std::mt19937 &rng){
+    int n = costs.size();
+    std::vector<double*> rows(n);
+    double **matrix = rows.data();
+
+    for(int i = 0; i < n; i++)
+        rows[i] = costs[i].data();
+
+    for(int cache = 0; cache < 2; cache++){
+        tParameters params;
+
+        params.quiet = true;
+        params.seed = 1;
+        params.restarts = 1;
+        params.stagnation = 1;
+        params.oropt_max = OROPT_MAX;
+        params.move_cache = cache;
+
+        MLP mlp(&matrix, n, params);
+        NeighborhoodCheck search(mlp, matrix);
+
+        for(int r = 0; r < NEIGHBORHOOD_ROUTES; r++){
+            std::vector<int> route(n+1, 0);
+
+            std::iota(route.begin()+1, route.end()-1, 1);
+            std::shuffle(route.begin()+1, route.end()-1, rng);
+
+            for(int index = 0; index < search.neighborhoods(); index++)
+                search.descend(index, route, name + (cache ? " (move cache)" : ""));
+        }
+    }
+}
+
+int main(){
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> coordinate(0, 1000),
+                                           arc(1, 1000);
+
+    for(int n : {7, 30, 60}){
+        std::vector<double> x(n), y(n);
+        std::vector<std::vector<double>> planar(n, std::vector<double>(n)),
+                                         asymmetric(n, std::vector<double>(n));
+
+        for(int i = 0; i < n; i++){
+            x[i] = coordinate(rng);
+            y[i] = coordinate(rng);
+        }
+
+        for(int i = 0; i < n; i++)
+            for(int j = 0; j < n; j++){
+                planar[i][j] = std::hypot(x[i] - x[j], y[i] - y[j]);
+                asymmetric[i][j] = i == j ? 0 : arc(rng);
+            }
+
+        checkMatrix(planar, std::to_string(n) + "-node planar", rng);
+        checkMatrix(asymmetric, std::to_string(n) + "-node asymmetric", rng);
+    }
+
+    return report("neighborhoods");
+}
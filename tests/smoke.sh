@@ -0,0 +1,64 @@
+#!/bin/sh
+# Round trip of the batch and server modes of the solver given as argument, run from the root of the repository:
+# a manifest with every kind of job, then the same jobs as requests to a server, twice so the second ones hit its
+# instance cache. Exits with the number of failed checks
+
+solver=$1
+dir=$(mktemp -d)
+server=
+failures=0
+
+trap 'if [ -n "$server" ]; then kill $server 2>/dev/null; fi; rm -rf "$dir"' EXIT
+
+fail(){
+    echo "FAILED: $1"
+    failures=$((failures+1))
+}
+
+# count file pattern expected what
+expect(){
+    found=$(grep -c "$2" "$1")
+    [ "$found" -eq "$3" ] || fail "$4: $found lines of $2 instead of $3"
+}
+
+cat > "$dir/jobs.txt" <<JOBS
+# Comments and blank lines are skipped
+
+instances/berlin52.tsp tsp 0.2
+instances/berlin52.tsp mlp 0.2 --perturb=local
+instances/burma14.tsp bb 10
+inline tsp 0.1 : 0 0 3 0 3 4 0 4 1 2
+instances/missing.tsp tsp 0.1
+JOBS
+
+"$solver" --batch="$dir/jobs.txt" --jobs=2 > "$dir/batch.jsonl"
+[ $? -eq 1 ] || fail "batch: the missing instance should fail the batch"
+expect "$dir/batch.jsonl" '"event":"result"' 4 "batch"
+expect "$dir/batch.jsonl" '"event":"error","job":4' 1 "batch"
+expect "$dir/batch.jsonl" '"instance":"instances/burma14.tsp","mode":"bb","cost":3323,' 1 "batch optimum"
+
+"$solver" --serve="$dir/socket" --jobs=2 > "$dir/server.log" 2>&1 &
+server=$!
+
+for attempt in 1 2 3 4 5 6 7 8 9 10; do
+    [ -S "$dir/socket" ] && break
+    sleep 0.5
+done
+
+grep -v '^#' "$dir/jobs.txt" | grep . > "$dir/requests.txt"
+echo "instances/berlin52.tsp tsp --stagnation" >> "$dir/requests.txt"
+
+for round in 1 2; do
+    "$solver" --client="$dir/socket" < "$dir/requests.txt" > "$dir/replies$round.jsonl"
+    [ $? -eq 1 ] || fail "client: the failed requests should fail the client"
+    expect "$dir/replies$round.jsonl" '"event":"result"' 4 "server round $round"
+    expect "$dir/replies$round.jsonl" '"event":"error"' 2 "server round $round"
+    grep -q '"event":"incumbent"' "$dir/replies$round.jsonl" || fail "server round $round: no incumbent streamed"
+    expect "$dir/replies$round.jsonl" '"mode":"bb","cost":3323,' 1 "server optimum round $round"
+done
+
+# The berlin52 MLP request of the first round, then every file request of the second one
+expect "$dir/server.log" 'cached' 4 "server cache"
+
+echo "smoke: $([ $failures -eq 0 ] && echo ok || echo "$failures failed")"
+exit $failures
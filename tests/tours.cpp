@@ -0,0 +1,126 @@
+#include "../src/include/osolver.h"
+#include "check.h"
+
+#include <cmath>
+#include <functional>
+
+#define TOURS_TIME_LIMIT 0.3 // Seconds of each solve, the routes are checked, not their quality
+
+// A structure that names a variant of the parameters
+struct tVariant{
+    const char *name;
+    std::function<void(tParameters &)> set;
+};
+
+// The route must start and end at the same node and visit every other node once
+bool closedTour(const std::vector<int> &route, int dimension){
+    std::vector<bool> visited(dimension, false);
+
+    if(route.size() != dimension + 1 || route.front() != route.back())
+        return false;
+
+    for(int k = 0; k < dimension; k++){
+        if(route[k] < 0 || route[k] >= dimension || visited[route[k]])
+            return false;
+        visited[route[k]] = true;
+    }
+
+    return true;
+}
+
+double tourCost(double **matrix, const std::vector<int> &route){
+    double cost = 0;
+
+    for(int k = 0; k+1 < route.size(); k++)
+        cost += matrix[route[k]][route[k+1]];
+
+    return cost;
+}
+
+// Sum of the arrival times at every position, the return to the depot included
+double latencyCost(double **matrix, const std::vector<int> &route){
+    double time = 0,
+           cost = 0;
+
+    for(int k = 0; k+1 < route.size(); k++){
+        time += matrix[route[k]][route[k+1]];
+        cost += time;
+    }
+
+    return cost;
+}
+
+// Solves every instance with the same solver, moved from one to the next, and recomputes the cost of each route
+void checkVariant(char mode, const tVariant &variant, const std::vector<const Instance*> &instances){
+    Problem *solver = NULL;
+
+    for(const Instance *instance : instances){
+        tParameters params;
+        std::string name = std::string(mode == 't' ? "TSP" : "MLP") + " " + variant.name + " on "
+                           + std::to_string(instance->getDimension()) + " nodes";
+
+        params.quiet = true;
+        params.seed = 1;
+        params.time_limit = TOURS_TIME_LIMIT;
+        variant.set(params);
+        instance->apply(params);
+
+        if(solver == NULL)
+            solver = mode == 't' ? (Problem*)new TSP(*instance, params) : (Problem*)new MLP(*instance, params);
+        else{
+            solver->setInstance(*instance);
+            solver->configure(params);
+        }
+
+        solver->solve();
+        tResult result = solver->result();
+
+        double cost = mode == 't' ? tourCost(instance->getMatrix(), result.route)
+                                  : latencyCost(instance->getMatrix(), result.route);
+
+        check(closedTour(result.route, instance->getDimension()), name + ": not a tour");
+        check(std::abs(cost - result.cost) < 1e-6, name + ": cost " + std::to_string(result.cost) + ", the route costs "
+                                                   + std::to_string(cost));
+    }
+
+    delete solver;
+}
+
+int main(){
+    Instance kroA100("instances/kroA100.tsp"),
+             berlin52("instances/berlin52.tsp"),
+             pr439("instances/pr439.tsp"),
+             gr17("instances/gr17.tsp");
+
+    const std::vector<tVariant> common = {
+        {"default", [](tParameters &p){}},
+        {"--oropt-max=8", [](tParameters &p){ p.oropt_max = 8; }},
+        {"--move-cache=0", [](tParameters &p){ p.move_cache = false; }},
+        {"--rvnd=adaptive", [](tParameters &p){ p.rvnd = 'a'; }},
+        {"--perturb=adaptive", [](tParameters &p){ p.perturbation = 'a'; }},
+        {"--perturb=local", [](tParameters &p){ p.perturbation = 'l'; }},
+        {"--construction=hilbert", [](tParameters &p){ p.construction = 'h'; }},
+        {"--construction=greedy", [](tParameters &p){ p.construction = 'g'; }},
+        {"--construction=nn", [](tParameters &p){ p.construction = 'n'; }},
+    };
+
+    const std::vector<tVariant> tsp = {
+        {"--ls=lk --tour=array", [](tParameters &p){ p.local_search = 'l'; p.tour = 'a'; }},
+        {"--ls=lk --tour=list", [](tParameters &p){ p.local_search = 'l'; p.tour = 'l'; }},
+        {"--ls=lk --perturb=local", [](tParameters &p){ p.local_search = 'l'; p.perturbation = 'l'; }},
+        {"--elite=4", [](tParameters &p){ p.elite = 4; }},
+        {"--decomposition=40 --threads=2", [](tParameters &p){ p.decomposition = 40; p.threads = 2; }},
+        {"--decomposition=40 --ls=lk", [](tParameters &p){ p.decomposition = 40; p.local_search = 'l'; }},
+    };
+
+    // gr17 has no coordinates, the planar constructions fall back to the candidate lists of its matrix
+    for(const tVariant &variant : common){
+        checkVariant('t', variant, {&kroA100, &berlin52, &gr17});
+        checkVariant('m', variant, {&berlin52, &kroA100, &gr17});
+    }
+
+    for(const tVariant &variant : tsp)
+        checkVariant('t', variant, {&pr439, &kroA100});
+
+    return report("tours");
+}